@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "global.h"
+#include "fileutils.h"
+#include "config_parser.h"
+#include "setting_group.h"
+#include "settings_file.h"
+#include "config_generator.h"
+
+using std::string;
+using std::vector;
+using std::cout, std::cerr, std::endl;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    int iterations = 20;
+    ConfigShape shape;
+
+    void printUsage() {
+        cout << "Usage: easyConfigBench [--groups N] [--items N] [--aliases N] [--iterations N]" << endl
+             << endl
+             << "--groups:      number of groups in synthetic config." << endl
+             << "--items:       number of items in each group." << endl
+             << "--aliases:     number of aliases used by item commands." << endl
+             << "--iterations:  number of timed runs of each benchmark." << endl
+             << endl
+             << "Results are printed to stdout as one json object per line." << endl;
+    }
+
+    // print statistics of timed runs as json line
+    void report(const string & name, vector<double> times, size_t units) {
+        std::sort(times.begin(), times.end());
+        double sum = 0;
+        for (auto t : times) sum += t;
+
+        char line[512];
+        snprintf(line, sizeof(line),
+            "{\"name\":\"%s\",\"iterations\":%zu,\"units\":%zu,"
+            "\"mean_us\":%.1f,\"min_us\":%.1f,\"p50_us\":%.1f,\"max_us\":%.1f}",
+            name.c_str(), times.size(), units,
+            sum / times.size(), times.front(), times[times.size() / 2], times.back());
+        cout << line << endl;
+    }
+
+    // time run() after prepare(), both are called once per iteration
+    vector<double> measure(const std::function<void()> & prepare, const std::function<void()> & run) {
+        vector<double> times;
+        for (int i = 0; i < iterations; i++) {
+            prepare();
+            auto start = Clock::now();
+            run();
+            times.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        return times;
+    }
+
+    void deleteGroups(vector<SettingGroup*> & groups) {
+        for (auto &group : groups) {
+            for (auto &item : group->getItems()) delete item;
+            delete group;
+        }
+        groups.clear();
+    }
+
+    // load settings, aliases are printed while loading so keep them out of results
+    vector<SettingGroup*> load(const string & filename, bool isUseCache) {
+        global::aliases.clear();
+        std::ostringstream discarded;
+        auto buffer = cout.rdbuf(discarded.rdbuf());
+        auto groups = loadSettingsFile(filename, isUseCache);
+        cout.rdbuf(buffer);
+        return groups;
+    }
+
+    size_t countItems(const vector<SettingGroup*> & groups) {
+        size_t count = 0;
+        for (auto &group : groups) count += group->getSize();
+        return count;
+    }
+
+    void removeOptionFiles(const vector<SettingGroup*> & groups) {
+        for (auto &group : groups) unlink(group->getOutputFilename().c_str());
+    }
+
+    bool readInt(const char *s, int &value) {
+        char *end;
+        long l = strtol(s, &end, 10);
+        if (*s == '\0' || *end != '\0' || l < 0 || l > 1000000) return false;
+        value = static_cast<int>(l);
+        return true;
+    }
+
+    void handleOptions(int argc, char *argv[]) {
+        for (int i = 1; i < argc; i++) {
+            string option = argv[i];
+            if (option == "-h" || option == "--help") {
+                printUsage();
+                exit(0);
+            }
+
+            int *value = nullptr;
+            if (option == "--groups") value = &shape.groups;
+            else if (option == "--items") value = &shape.itemsPerGroup;
+            else if (option == "--aliases") value = &shape.aliases;
+            else if (option == "--iterations") value = &iterations;
+
+            if (value == nullptr || i + 1 >= argc || !readInt(argv[i + 1], *value)) {
+                cerr << "easyConfigBench: invalid option: " << option << endl;
+                printUsage();
+                exit(1);
+            }
+            i++;
+        }
+        if (shape.groups < 1) shape.groups = 1;
+        if (iterations < 1) iterations = 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    global::programName = "easyConfigBench";
+    handleOptions(argc, argv);
+
+    // synthetic config and option files are written into temporary directory
+    char directory[] = "/tmp/easyConfigBench.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        cerr << "easyConfigBench: cannot create temporary directory" << endl;
+        return 1;
+    }
+    string configFilename = string(directory) + "/synthetic.cfg";
+    string cacheFilename = configFilename + ".cache";
+    string configText = generateConfig(shape, directory);
+    if (!File_utils::writeFileAtomic(configFilename, configText)) {
+        cerr << "easyConfigBench: cannot write file: " << configFilename << endl;
+        return 1;
+    }
+
+    // load from text and from compiled cache
+    vector<SettingGroup*> groups;
+    auto unload = [&groups]() { deleteGroups(groups); };
+    auto times = measure(unload, [&]() {
+        groups = load(configFilename, false);
+    });
+    report("loadConfigFile", times, countItems(groups));
+
+    load(configFilename, true);
+    unload();
+    times = measure(unload, [&]() {
+        groups = load(configFilename, true);
+    });
+    report("loadConfigFile_cached", times, countItems(groups));
+
+    // strings split and expanded on loading, measured over all items
+    vector<string> fields, commands;
+    for (auto &group : groups) {
+        for (auto &item : group->getItems()) {
+            fields.push_back(item->getOptionsString());
+            fields.push_back(item->getDisplayValuesString_());
+            commands.push_back(item->getCommandsString());
+        }
+    }
+    size_t tokenCount = 0;
+    report("split", measure([]() {}, [&]() {
+        for (auto &field : fields) tokenCount += split(field, "|").size();
+    }), fields.size());
+
+    size_t expandedLength = 0;
+    report("replaceAliases", measure([]() {}, [&]() {
+        for (auto &command : commands) expandedLength += global::replaceAliases(command).length();
+    }), commands.size());
+
+    // change every fourth value, restore config file before each save
+    // so every run patches and writes the file
+    size_t changedCount = 0;
+    for (auto &group : groups) {
+        for (size_t i = 0; i < group->getItems().size(); i += 4) {
+            group->getItems()[i]->selectNextValue();
+            changedCount++;
+        }
+    }
+    report("saveConfigFile", measure([&]() {
+        File_utils::writeFileAtomic(configFilename, configText);
+    }, [&]() {
+        saveSettingsFile(configFilename, groups, false);
+    }), changedCount);
+
+    // config file shortened by someone else since loading, values are
+    // no longer where they were loaded from and whole file is written
+    report("saveConfigFile_edited", measure([&]() {
+        File_utils::writeFileAtomic(configFilename, configText.substr(0, configText.length() / 2));
+    }, [&]() {
+        saveSettingsFile(configFilename, groups, false);
+    }), changedCount);
+
+    report("saveOptionsFile", measure([&]() {
+        removeOptionFiles(groups);
+    }, [&]() {
+        saveOptionFiles(groups);
+    }), groups.size());
+
+    // clean up temporary files
+    removeOptionFiles(groups);
+    unlink(configFilename.c_str());
+    unlink(cacheFilename.c_str());
+    rmdir(directory);
+    unload();
+
+    // keep results of split and replaceAliases alive
+    if (tokenCount == 0 && expandedLength == 0) cerr << "easyConfigBench: empty config" << endl;
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "config_generator.h"
+
+#include <sstream>
+
+using std::ostringstream;
+
+namespace {
+    const char *VALUE_SETS[][2] = {
+        { "on|off", "on|off" },
+        { "10|20|30", "Slow|Normal|Fast" },
+        { "0|1|2|3|4|5|6|7", "Off|1|2|3|4|5|6|Max" },
+        { "|", "on|off" },
+    };
+    const int VALUE_SET_COUNT = sizeof(VALUE_SETS) / sizeof(VALUE_SETS[0]);
+
+    string aliasName(int index) {
+        return "$ALIAS_" + std::to_string(index) + '$';
+    }
+}
+
+string generateConfig(const ConfigShape & shape, const string & outputDirectory)
+{
+    ostringstream text;
+
+    // long aliases, as used for script paths and common arguments
+    text << "# synthetic config" << '\n';
+    for (int i = 0; i < shape.aliases; i++)
+    {
+        text << "$ALIAS_" << i << "=/mnt/SDCARD/App/Synthetic/scripts/setting_" << i
+             << ".sh --config /mnt/SDCARD/.tmp_update/config/synthetic.cfg$" << '\n';
+    }
+    text << '\n';
+
+    int itemIndex = 0;
+    for (int g = 0; g < shape.groups; g++)
+    {
+        text << "[Group " << g << "] [" << outputDirectory << "/options_" << g << "]" << '\n';
+        for (int i = 0; i < shape.itemsPerGroup; i++, itemIndex++)
+        {
+            const auto &values = VALUE_SETS[itemIndex % VALUE_SET_COUNT];
+            string alias = shape.aliases > 0 ? aliasName(itemIndex % shape.aliases) : "echo";
+            string current = values[1];
+            current = current.substr(0, current.find('|'));
+
+            text << "\"-o" << itemIndex << "\" \"Synthetic setting number " << itemIndex << "\" "
+                 << '"' << values[0] << "\" \"" << values[1] << "\" \"" << current << "\" "
+                 << '"' << alias << " _INDEX_ _VALUE_" << "\"";
+            if (i % 4 == 0)
+                text << " \"\" \"order=group" << g << "\"";
+            text << '\n';
+
+            if (i % 5 == 0)
+                text << "@\"Minor text of setting " << itemIndex << "\"" << '\n';
+            if (i % 10 == 0)
+                text << "  # comment kept when saving" << '\n';
+        }
+        text << '\n';
+    }
+
+    return text.str();
+}
@@ -0,0 +1,20 @@
+#ifndef CONFIG_GENERATOR_H
+#define CONFIG_GENERATOR_H
+
+#include <string>
+
+using std::string;
+
+// size of synthetic config file
+struct ConfigShape {
+    int groups = 50;
+    int itemsPerGroup = 60;
+    int aliases = 200;
+};
+
+// generate config text with aliases, groups writing option files into
+// outputDirectory, items using aliases in commands, minor texts and comments,
+// commands are never run so they do not need to exist
+string generateConfig(const ConfigShape & shape, const string & outputDirectory);
+
+#endif // CONFIG_GENERATOR_H
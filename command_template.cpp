@@ -0,0 +1,68 @@
+#include "command_template.h"
+
+#include "global.h"
+
+namespace {
+    const string INDEX_PLACEHOLDER = "_INDEX_";
+    const string VALUE_PLACEHOLDER = "_VALUE_";
+}
+
+CommandTemplate::CommandTemplate(const string & command)
+{
+    string s = global::replaceAliases(command);
+
+    // split at placeholders, _INDEX_ is found before _VALUE_ as in old replacement order
+    size_t start = 0;
+    while (start < s.length()) {
+        size_t indexPos = s.find(INDEX_PLACEHOLDER, start);
+        size_t end = (indexPos != string::npos) ? indexPos : s.length();
+
+        // split text before _INDEX_ at _VALUE_
+        size_t valuePos;
+        while ((valuePos = s.find(VALUE_PLACEHOLDER, start)) != string::npos &&
+            valuePos + VALUE_PLACEHOLDER.length() <= end) {
+            addText(s.substr(start, valuePos - start));
+            pieces_.push_back({ PieceType::value, "" });
+            start = valuePos + VALUE_PLACEHOLDER.length();
+        }
+        addText(s.substr(start, end - start));
+
+        if (indexPos == string::npos) break;
+        pieces_.push_back({ PieceType::index, "" });
+        start = indexPos + INDEX_PLACEHOLDER.length();
+    }
+}
+
+void CommandTemplate::addText(string text)
+{
+    if (text.empty()) return;
+    textLength_ += text.length();
+    pieces_.push_back({ PieceType::text, std::move(text) });
+}
+
+void CommandTemplate::expand(string & buffer, unsigned int index, const string & value) const
+{
+    buffer.clear();
+    buffer.reserve(textLength_ + value.length() * 2 + 16);
+
+    for (const auto &piece : pieces_) {
+        switch (piece.type) {
+        case PieceType::text:
+            buffer += piece.text;
+            break;
+        case PieceType::index:
+            buffer += std::to_string(index);
+            break;
+        case PieceType::value:
+            buffer += value;
+            break;
+        }
+    }
+}
+
+string CommandTemplate::expand(unsigned int index, const string & value) const
+{
+    string buffer;
+    expand(buffer, index, value);
+    return buffer;
+}
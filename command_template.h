@@ -0,0 +1,38 @@
+#ifndef COMMAND_TEMPLATE_H
+#define COMMAND_TEMPLATE_H
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// command compiled into literal pieces and _INDEX_ / _VALUE_ slots,
+// aliases are replaced by their values when compiled
+class CommandTemplate
+{
+public:
+    CommandTemplate() = default;
+    explicit CommandTemplate(const string & command);
+
+    bool empty() const { return pieces_.empty(); }
+
+    // write command with placeholders filled in to buffer, buffer is
+    // cleared first so it can be reused between calls
+    void expand(string & buffer, unsigned int index, const string & value) const;
+    string expand(unsigned int index, const string & value) const;
+
+private:
+    enum class PieceType : unsigned char { text, index, value };
+    struct Piece {
+        PieceType type;
+        string text;
+    };
+
+    void addText(string text);
+
+    vector<Piece> pieces_;
+    size_t textLength_ = 0;
+};
+
+#endif // COMMAND_TEMPLATE_H
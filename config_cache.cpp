@@ -0,0 +1,212 @@
+#include "config_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <sys/stat.h>
+
+namespace {
+    const char MAGIC[8] = {'E', 'A', 'S', 'Y', 'C', 'F', 'G', '3'};
+
+    // config file identity stored in cache header
+    struct ConfigStamp {
+        uint64_t size;
+        int64_t modifiedSeconds;
+        int64_t modifiedNanoseconds;
+        uint64_t contentHash;
+    };
+
+    // 64-bit FNV-1a
+    uint64_t hashContent(string_view data) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (char c : data) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // size and modification time only, content hash is set by caller
+    bool getConfigStamp(const string & filename, ConfigStamp &stamp) {
+        struct stat fileStat;
+        if (stat(filename.c_str(), &fileStat) != 0) return false;
+
+        stamp.size = static_cast<uint64_t>(fileStat.st_size);
+        stamp.modifiedSeconds = static_cast<int64_t>(fileStat.st_mtim.tv_sec);
+        stamp.modifiedNanoseconds = static_cast<int64_t>(fileStat.st_mtim.tv_nsec);
+        stamp.contentHash = 0;
+        return true;
+    }
+
+    const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(ConfigStamp) + sizeof(uint32_t);
+}
+
+ConfigCacheReader::ConfigCacheReader(const string & cacheFilename, const string & configFilename)
+    : file_(cacheFilename)
+{
+    if (!file_.isOpen()) return;
+
+    data_ = file_.getData();
+    if (data_.length() < HEADER_SIZE) return;
+    if (memcmp(data_.data(), MAGIC, sizeof(MAGIC)) != 0) return;
+
+    // compare stamp of config file
+    ConfigStamp cachedStamp, stamp;
+    memcpy(&cachedStamp, data_.data() + sizeof(MAGIC), sizeof(cachedStamp));
+    if (!getConfigStamp(configFilename, stamp)) return;
+    if (cachedStamp.size != stamp.size ||
+        cachedStamp.modifiedSeconds != stamp.modifiedSeconds ||
+        cachedStamp.modifiedNanoseconds != stamp.modifiedNanoseconds) return;
+
+    // modification time is too coarse on some file systems (2 seconds on FAT),
+    // an edit keeping the size may not change it, so compare content too
+    {
+        ConfigFile config(configFilename);
+        if (!config.isOpen() || config.getData().length() != stamp.size) return;
+        if (hashContent(config.getData()) != cachedStamp.contentHash) return;
+    }
+
+    uint32_t recordCount;
+    memcpy(&recordCount, data_.data() + sizeof(MAGIC) + sizeof(ConfigStamp), sizeof(recordCount));
+
+    // check all records before any is used, so a broken cache is never half loaded
+    pos_ = recordsPos_ = HEADER_SIZE;
+    ConfigRecord record;
+    for (uint32_t i = 0; i < recordCount; i++) {
+        if (!readRecord(record)) return;
+    }
+    if (pos_ != data_.length()) return;
+
+    pos_ = recordsPos_;
+    isValid_ = true;
+}
+
+bool ConfigCacheReader::nextRecord(ConfigRecord &record)
+{
+    if (!isValid_ || pos_ >= data_.length()) return false;
+    return readRecord(record);
+}
+
+bool ConfigCacheReader::readSize(size_t &size)
+{
+    uint32_t value;
+    if (data_.length() - pos_ < sizeof(value)) return false;
+    memcpy(&value, data_.data() + pos_, sizeof(value));
+    pos_ += sizeof(value);
+
+    size = value;
+    return true;
+}
+
+bool ConfigCacheReader::readString(string_view &s)
+{
+    size_t length;
+    if (!readSize(length)) return false;
+
+    if (data_.length() - pos_ < length) return false;
+    s = data_.substr(pos_, length);
+    pos_ += length;
+    return true;
+}
+
+bool ConfigCacheReader::readRecord(ConfigRecord &record)
+{
+    if (data_.length() - pos_ < 2) return false;
+    auto type = static_cast<unsigned char>(data_[pos_]);
+    auto fieldCount = static_cast<unsigned char>(data_[pos_ + 1]);
+    pos_ += 2;
+    if (type > static_cast<unsigned char>(ConfigRecordType::item)) return false;
+    if (fieldCount > ConfigRecord::MAX_FIELDS) return false;
+
+    record = ConfigRecord();
+    record.type = static_cast<ConfigRecordType>(type);
+    record.fieldCount = fieldCount;
+    if (!readSize(record.lineOffset) || !readSize(record.valueStart) ||
+        !readSize(record.valueLength)) return false;
+    if (!readString(record.line)) return false;
+    if (record.valueStart + record.valueLength > record.line.length()) return false;
+    for (size_t i = 0; i < record.fieldCount; i++) {
+        if (!readString(record.fields[i])) return false;
+    }
+    return true;
+}
+
+ConfigCacheWriter::ConfigCacheWriter(const string & configFilename, string_view configData)
+{
+    ConfigStamp stamp = {0, 0, 0, 0};
+    isConfigFound_ = getConfigStamp(configFilename, stamp) && stamp.size == configData.length();
+    stamp.contentHash = hashContent(configData);
+
+    header_.append(MAGIC, sizeof(MAGIC));
+    header_.append(reinterpret_cast<const char*>(&stamp), sizeof(stamp));
+}
+
+void ConfigCacheWriter::add(const ConfigRecord &record)
+{
+    records_ += static_cast<char>(record.type);
+    records_ += static_cast<char>(record.fieldCount);
+    appendSize(record.lineOffset);
+    appendSize(record.valueStart);
+    appendSize(record.valueLength);
+    appendString(record.line);
+    for (size_t i = 0; i < record.fieldCount; i++) appendString(record.fields[i]);
+    recordCount_++;
+}
+
+void ConfigCacheWriter::appendSize(size_t size)
+{
+    auto value = static_cast<uint32_t>(size);
+    records_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void ConfigCacheWriter::appendString(string_view s)
+{
+    appendSize(s.length());
+    records_.append(s.data(), s.length());
+}
+
+bool ConfigCacheWriter::save(const string & cacheFilename) const
+{
+    if (!isConfigFound_) return false;
+
+    // write complete file before replacing old cache
+    string tempFilename = cacheFilename + ".tmp";
+    std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    file.write(header_.data(), static_cast<std::streamsize>(header_.length()));
+    file.write(reinterpret_cast<const char*>(&recordCount_), sizeof(recordCount_));
+    file.write(records_.data(), static_cast<std::streamsize>(records_.length()));
+    file.close();
+
+    if (file.fail() || rename(tempFilename.c_str(), cacheFilename.c_str()) != 0) {
+        remove(tempFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+string getConfigCacheFilename(const string & configFilename)
+{
+    return configFilename + ".cache";
+}
+
+bool compileConfigCache(const string & configFilename, const string & cacheFilename)
+{
+    ConfigFile file(configFilename);
+    if (!file.isOpen()) return false;
+    ConfigCacheWriter writer(configFilename, file.getData());
+
+    string_view line;
+    while (file.nextLine(line)) {
+        ConfigLineReader reader(line);
+        ConfigRecord record;
+        string errorMessage;
+        if (!parseConfigLine(line, reader, record, errorMessage)) return false;
+        record.lineOffset = file.getOffset(line);
+        writer.add(record);
+    }
+
+    return writer.save(cacheFilename);
+}
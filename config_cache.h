@@ -0,0 +1,68 @@
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "config_parser.h"
+
+using std::string;
+using std::string_view;
+
+// Compiled config file is a list of parsed records in file order, valid
+// while size, modification time and content hash of the config file are unchanged.
+
+// reader of compiled config, records are views into the mapped cache file
+class ConfigCacheReader
+{
+public:
+    explicit ConfigCacheReader(const string & cacheFilename, const string & configFilename);
+
+    // cache file exists, is complete and matches config file
+    bool isValid() const { return isValid_; }
+
+    // get next record, return false after last record
+    bool nextRecord(ConfigRecord &record);
+
+private:
+    bool readSize(size_t &size);
+    bool readString(string_view &s);
+    bool readRecord(ConfigRecord &record);
+
+    ConfigFile file_;
+    string_view data_;
+    size_t pos_ = 0;
+    size_t recordsPos_ = 0;
+    bool isValid_ = false;
+};
+
+// writer of compiled config, stats config file and hashes its parsed
+// content when constructed
+class ConfigCacheWriter
+{
+public:
+    ConfigCacheWriter(const string & configFilename, string_view configData);
+
+    void add(const ConfigRecord &record);
+
+    // write to temporary file and rename, return false if failed
+    bool save(const string & cacheFilename) const;
+
+private:
+    void appendSize(size_t size);
+    void appendString(string_view s);
+
+    bool isConfigFound_ = false;
+    uint32_t recordCount_ = 0;
+    string header_;
+    string records_;
+};
+
+string getConfigCacheFilename(const string & configFilename);
+
+// parse config file as text and write its compiled form,
+// return false if file cannot be parsed or cache cannot be written
+bool compileConfigCache(const string & configFilename, const string & cacheFilename);
+
+#endif // CONFIG_CACHE_H
@@ -0,0 +1,240 @@
+#include "config_parser.h"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // same characters as std::isspace in C locale
+    bool isSpace(char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+    }
+
+    string_view trim(string_view s) {
+        while (!s.empty() && isSpace(s.front())) s.remove_prefix(1);
+        while (!s.empty() && isSpace(s.back())) s.remove_suffix(1);
+        return s;
+    }
+}
+
+ConfigFile::ConfigFile(const string & filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        return;
+    }
+
+    if (fileStat.st_size > 0) {
+        size_ = static_cast<size_t>(fileStat.st_size);
+        void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            data_ = static_cast<const char*>(data);
+            isMapped_ = true;
+            isOpen_ = true;
+        } else {
+            size_ = 0;
+        }
+    } else {
+        // nothing to map for empty file
+        isOpen_ = true;
+    }
+
+    close(fd);
+}
+
+ConfigFile::~ConfigFile()
+{
+    if (isMapped_) munmap(const_cast<char*>(data_), size_);
+}
+
+bool ConfigFile::nextLine(string_view &line)
+{
+    while (pos_ < size_) {
+        // find end of current line
+        const char *start = data_ + pos_;
+        const char *end = static_cast<const char*>(memchr(start, '\n', size_ - pos_));
+        size_t length = (end != nullptr) ? static_cast<size_t>(end - start) : size_ - pos_;
+        pos_ += length + 1;
+
+        // skip empty line and line start with '#'
+        line = trim(string_view(start, length));
+        if (line.empty() || line.front() == '#') continue;
+
+        return true;
+    }
+    return false;
+}
+
+ConfigLineReader::ConfigLineReader(string_view line)
+    : rest_(line)
+{
+    // unescaped fields are never longer than the line,
+    // so views into scratch buffer stay valid
+    scratch_.reserve(line.length());
+}
+
+void ConfigLineReader::skip(size_t count)
+{
+    rest_.remove_prefix(count < rest_.length() ? count : rest_.length());
+}
+
+bool ConfigLineReader::readQuoted(string_view &field, char delimiter)
+{
+    while (!rest_.empty() && isSpace(rest_.front())) rest_.remove_prefix(1);
+    if (rest_.empty()) return false;
+
+    const char *start = rest_.data();
+    bool isRead;
+    if (rest_.front() != delimiter) {
+        isRead = readWord(field);
+    } else {
+        rest_.remove_prefix(1);
+        isRead = readEnclosed(field, delimiter);
+    }
+    rawField_ = string_view(start, static_cast<size_t>(rest_.data() - start));
+    return isRead;
+}
+
+bool ConfigLineReader::readBracketed(string_view &field)
+{
+    while (!rest_.empty() && isSpace(rest_.front())) rest_.remove_prefix(1);
+    if (rest_.empty()) return false;
+
+    const char *start = rest_.data();
+    bool isRead;
+    if (rest_.front() != '[') {
+        isRead = readWord(field);
+    } else {
+        rest_.remove_prefix(1);
+        isRead = readEnclosed(field, ']');
+    }
+    rawField_ = string_view(start, static_cast<size_t>(rest_.data() - start));
+    return isRead;
+}
+
+bool ConfigLineReader::readWord(string_view &field)
+{
+    size_t length = 0;
+    while (length < rest_.length() && !isSpace(rest_[length])) length++;
+
+    field = rest_.substr(0, length);
+    rest_.remove_prefix(length);
+    return true;
+}
+
+bool ConfigLineReader::readEnclosed(string_view &field, char close)
+{
+    // find closing character, backslash escapes next character
+    size_t i = 0;
+    bool hasEscape = false;
+    while (i < rest_.length() && rest_[i] != close) {
+        if (rest_[i] == '\\') {
+            hasEscape = true;
+            i++;
+        }
+        i++;
+    }
+    bool isClosed = i < rest_.length();
+    size_t length = i < rest_.length() ? i : rest_.length();
+
+    if (!hasEscape) {
+        field = rest_.substr(0, length);
+    } else {
+        // copy unescaped characters to scratch buffer
+        size_t start = scratch_.length();
+        for (size_t j = 0; j < length; j++) {
+            if (rest_[j] == '\\') j++;
+            if (j < length) scratch_ += rest_[j];
+        }
+        field = string_view(scratch_.data() + start, scratch_.length() - start);
+    }
+
+    rest_.remove_prefix(isClosed ? length + 1 : length);
+    return isClosed;
+}
+
+bool parseConfigLine(string_view line, ConfigLineReader &reader, ConfigRecord &record,
+    string &errorMessage)
+{
+    record = ConfigRecord();
+    record.line = line;
+
+    // handle alias, fields are name and value
+    if (line.front() == '$') {
+        record.type = ConfigRecordType::alias;
+
+        string_view pair;
+        if (!reader.readQuoted(pair, '$')) {
+            errorMessage = "cannot process line1: ";
+            return false;
+        }
+
+        auto pos = pair.find("=");
+        if (pos == string::npos || pos == 0 || pos >= pair.length() - 1) {
+            errorMessage = "cannot process line2: ";
+            return false;
+        }
+
+        record.fields[0] = pair.substr(0, pos);
+        record.fields[1] = pair.substr(pos + 1);
+        record.fieldCount = 2;
+        return true;
+    }
+
+    errorMessage = "cannot process line: ";
+
+    // handle setting group, fields are name and output filename
+    if (line.front() == '[') {
+        record.type = ConfigRecordType::group;
+        record.fieldCount = 2;
+
+        // read group name and try read output filename
+        if (!reader.readBracketed(record.fields[0])) return false;
+        reader.readBracketed(record.fields[1]);
+        return true;
+    }
+
+    // handle minor text and info text, skip first character
+    if (line.front() == '@' || line.front() == '%') {
+        record.type = (line.front() == '@') ?
+            ConfigRecordType::minorText : ConfigRecordType::infoText;
+        record.fieldCount = 1;
+
+        reader.skip(1);
+        reader.readQuoted(record.fields[0]);
+        return !record.fields[0].empty();
+    }
+
+    // handle setting item, the last three fields are optional
+    record.type = ConfigRecordType::item;
+    record.fieldCount = ConfigRecord::MAX_FIELDS;
+    for (size_t i = 0; i < 5; i++) {
+        if (!reader.readQuoted(record.fields[i])) return false;
+    }
+    string_view rawValue = reader.getRawField();
+    record.valueStart = static_cast<size_t>(rawValue.data() - line.data());
+    record.valueLength = rawValue.length();
+    for (size_t i = 5; i < ConfigRecord::MAX_FIELDS; i++) {
+        if (!reader.readQuoted(record.fields[i])) break;
+    }
+    return true;
+}
+
+vector<string> split(const string& s, const string& delimiter) {
+    vector<string> tokens;
+    size_t start = 0, pos = 0;
+    while ((pos = s.find(delimiter, start)) != string::npos) {
+        tokens.emplace_back(s, start, pos - start);
+        start = pos + delimiter.length();
+    }
+    tokens.emplace_back(s, start);
+
+    return tokens;
+}
@@ -0,0 +1,102 @@
+#ifndef CONFIG_PARSER_H
+#define CONFIG_PARSER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+// config file mapped into memory, read as trimmed lines
+class ConfigFile
+{
+public:
+    explicit ConfigFile(const string & filename);
+    ~ConfigFile();
+
+    // disallow copying and assignment
+    ConfigFile(const ConfigFile &) = delete;
+    ConfigFile &operator=(const ConfigFile &) = delete;
+
+    bool isOpen() const { return isOpen_; }
+
+    // get next line without surrounding spaces, skipping empty lines and
+    // comments, return false at end of file
+    bool nextLine(string_view &line);
+
+    string_view getData() const { return string_view(data_, size_); }
+
+    // offset of line returned by nextLine() in file
+    size_t getOffset(string_view line) const { return static_cast<size_t>(line.data() - data_); }
+
+private:
+    bool isOpen_ = false;
+    bool isMapped_ = false;
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+};
+
+// kinds of config lines
+enum class ConfigRecordType : unsigned char { alias, group, minorText, infoText, item };
+
+// fields of one config line, views into the line or its reader
+struct ConfigRecord
+{
+    static const size_t MAX_FIELDS = 8;
+
+    ConfigRecordType type = ConfigRecordType::item;
+    string_view line;
+    string_view fields[MAX_FIELDS];
+    size_t fieldCount = 0;
+
+    // position of line in config file, and raw text of CURRENT_VALUE
+    // field of item in line, so the value can be replaced in place
+    size_t lineOffset = 0;
+    size_t valueStart = 0;
+    size_t valueLength = 0;
+};
+
+// tokenizer of fields in one config line, fields are views into the line
+// unless they contain escaped characters
+class ConfigLineReader
+{
+public:
+    explicit ConfigLineReader(string_view line);
+
+    // disallow copying and assignment, fields may point to scratch buffer
+    ConfigLineReader(const ConfigLineReader &) = delete;
+    ConfigLineReader &operator=(const ConfigLineReader &) = delete;
+
+    // read field enclosed by delimiter, or a plain word, like std::quoted
+    bool readQuoted(string_view &field, char delimiter = '"');
+
+    // read field enclosed by square brackets, or a plain word
+    bool readBracketed(string_view &field);
+
+    // skip characters at the beginning of remaining line
+    void skip(size_t count);
+
+    // raw text of last read field including delimiters
+    string_view getRawField() const { return rawField_; }
+
+private:
+    bool readEnclosed(string_view &field, char close);
+    bool readWord(string_view &field);
+
+    string_view rest_;
+    string_view rawField_;
+    string scratch_;
+};
+
+// split config line into fields of record, set error message if line is invalid
+bool parseConfigLine(string_view line, ConfigLineReader &reader, ConfigRecord &record,
+    string &errorMessage);
+
+// split string with delimiter into vector of tokens
+vector<string> split(const string& s, const string& delimiter);
+
+#endif // CONFIG_PARSER_H
@@ -2,13 +2,16 @@
 
 #include <array>
 #include <cerrno>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <fstream>
 #include <sstream>
 
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -89,3 +92,55 @@ string File_utils::getCWP()
         return "";
     }
 }
+
+bool File_utils::hasContent(const string &p_path, const string &p_content)
+{
+    struct stat l_stat;
+    if (stat(p_path.c_str(), &l_stat) != 0 || static_cast<size_t>(l_stat.st_size) != p_content.size())
+        return false;
+
+    std::ifstream l_file(p_path, std::ios::binary);
+    if (!l_file.is_open())
+        return false;
+
+    string l_data(p_content.size(), '\0');
+    l_file.read(&l_data[0], static_cast<std::streamsize>(l_data.size()));
+    return l_file.gcount() == static_cast<std::streamsize>(l_data.size()) && l_data == p_content;
+}
+
+bool File_utils::writeFileAtomic(const string &p_path, const string &p_content)
+{
+    // keep permissions of replaced file
+    mode_t l_mode = 0644;
+    struct stat l_stat;
+    if (stat(p_path.c_str(), &l_stat) == 0)
+        l_mode = l_stat.st_mode & 07777;
+
+    const string l_tempPath = p_path + ".tmp";
+    int l_fd = open(l_tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, l_mode);
+    if (l_fd < 0)
+        return false;
+    fchmod(l_fd, l_mode);
+
+    size_t l_written = 0;
+    while (l_written < p_content.size())
+    {
+        ssize_t l_length = write(l_fd, p_content.data() + l_written, p_content.size() - l_written);
+        if (l_length < 0 && errno == EINTR)
+            continue;
+        if (l_length <= 0)
+            break;
+        l_written += static_cast<size_t>(l_length);
+    }
+
+    bool l_isOk = l_written == p_content.size() && fsync(l_fd) == 0;
+    if (close(l_fd) != 0)
+        l_isOk = false;
+
+    if (!l_isOk || rename(l_tempPath.c_str(), p_path.c_str()) != 0)
+    {
+        unlink(l_tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -21,6 +21,13 @@ namespace File_utils
     string getPath(const string &p_path);
 
     string getCWP();
+
+    // check if file exists with exactly the given content
+    bool hasContent(const string &p_path, const string &p_content);
+
+    // write content to temporary file, sync it and rename it to path,
+    // so the file is never left partly written
+    bool writeFileAtomic(const string &p_path, const string &p_content);
 }
 
 #endif
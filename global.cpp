@@ -1,51 +1,101 @@
 #include "global.h"
 
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string_view>
+#include <thread>
+
 #include <SDL.h>
 
 namespace global
 {
-    void replaceText(string & str, const string & key, const string & value, std::size_t start);
-
 	SDL_Renderer *renderer;
     TTF_Font *font;
+    GlyphAtlas *glyphAtlas;
     SDL_Color text_color = {235, 219, 178, 255};
     SDL_Color minor_text_color = {124, 111, 100, 255};
-    map<string, string> aliases;
-    
-    void replaceText(string & str, const string & key, const string & value, std::size_t start=0) {
-        while (true) {
-            auto pos = str.find(key, start);
-            if (pos == string::npos) break;
-            str.replace(pos, key.length(), value);
-            start = pos + value.length();
-            if (start >= str.length()) break;
-        }
-    }
+    map<string, string, std::less<>> aliases;
+    string programName;
 
-    string replaceAliases(const string & str) {
-        // replace aliases with corresponding value
-        string s = str;
-        std::size_t first = s.find("$");
-        if (first == string::npos) return s;
-
-        for (const auto& [key, value] : global::aliases)
-        {
-            replaceText(s, key, value, first);
+    // created before command workers, which use them until they are joined
+    Profiler profiler;
+    Tracer tracer;
+
+    // commands mostly wait on the shell, so allow more workers than cores
+    WorkerPool commandPool(std::clamp(std::thread::hardware_concurrency() * 2, 4u, 8u));
+
+    namespace {
+        // aliases with their values expanded, used for replacing
+        map<string, string, std::less<>> expandedAliases;
+
+        // replace $name$ in one scan, lookup returns nullptr for unknown name
+        string replaceNames(const string & str,
+            const std::function<const string*(std::string_view)> & lookup) {
+            // aliases are $name$, look up text between each pair of '$'
+            string s;
+            s.reserve(str.length());
+            std::size_t start = 0;
+            while (true) {
+                auto first = str.find('$', start);
+                if (first == string::npos) break;
+                auto last = str.find('$', first + 1);
+                if (last == string::npos) break;
+
+                auto value = lookup(std::string_view(str).substr(first, last - first + 1));
+                if (value != nullptr) {
+                    s.append(str, start, first - start);
+                    s += *value;
+                    start = last + 1;
+                } else {
+                    // closing '$' may start another alias
+                    s.append(str, start, last - start);
+                    start = last;
+                }
+            }
+            s.append(str, start, string::npos);
+            return s;
         }
-        return s;
-    }
 
-    string replaceAliases(const string & str, unsigned int index, const string & value) {
-        // first replace user aliases
-        string s = replaceAliases(str);
+        // expand aliases in value of alias first, an alias used while
+        // expanding itself is left as it is
+        const string * expandAlias(std::string_view name, std::set<std::string_view> & expanding) {
+            auto expanded = expandedAliases.find(name);
+            if (expanded != expandedAliases.end()) return &expanded->second;
+            auto alias = aliases.find(name);
+            if (alias == aliases.end()) return nullptr;
+            if (!expanding.insert(alias->first).second) return nullptr;
 
-        // try to replace _INDEX_
-        replaceText(s, "_INDEX_", std::to_string(index));
+            string value = replaceNames(alias->second, [&expanding](std::string_view usedName) {
+                return expandAlias(usedName, expanding);
+            });
+            expanding.erase(alias->first);
+            return &expandedAliases.emplace(alias->first, std::move(value)).first->second;
+        }
+    }
 
-        // try to replace _VALUE_
-        replaceText(s, "_VALUE_", value);
+    void expandAliases() {
+        expandedAliases.clear();
+        std::set<std::string_view> expanding;
+        for (const auto &alias : aliases) expandAlias(alias.first, expanding);
+    }
 
-        return s;
+    string replaceAliases(const string & str) {
+        return replaceNames(str, [](std::string_view name) -> const string* {
+            auto it = expandedAliases.find(name);
+            return it != expandedAliases.end() ? &it->second : nullptr;
+        });
     }
 
+    void printErrorAndExit(const string & message, const string & extraMessage)
+	{
+		std::cerr << programName << ": " << message;
+		if (!extraMessage.empty())
+			std::cerr << extraMessage;
+		std::cerr << std::endl
+			 << std::endl;
+		exit(0);
+	}
+
 } // namespace constants
@@ -11,19 +11,43 @@ using std::map;
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 
+#include "worker_pool.h"
+#include "profiler.h"
+#include "tracer.h"
+
+class GlyphAtlas;
+
 namespace global
 {
+    // physical screen is portrait
     const int SCREEN_WIDTH = 480;
     const int SCREEN_HEIGHT = 640;
 
+    // UI is composed in landscape and rotated once on present
+    const int LOGICAL_WIDTH = SCREEN_HEIGHT;
+    const int LOGICAL_HEIGHT = SCREEN_WIDTH;
+
     extern SDL_Renderer *renderer;
     extern TTF_Font *font;
+    extern GlyphAtlas *glyphAtlas;
     extern SDL_Color text_color;
     extern SDL_Color minor_text_color;
-    extern map<string, string> aliases;
+    // aliases with values as written in config file
+    extern map<string, string, std::less<>> aliases;
+    extern WorkerPool commandPool;
+    extern Profiler profiler;
+    extern Tracer tracer;
+    extern string programName;
+
+    // print error message with program name and exit
+    void printErrorAndExit(const string & message, const string & extraMessage = "");
+
+    // expand aliases used in values of other aliases, in any order,
+    // call after aliases are changed
+    void expandAliases();
 
+    // replace aliases with their expanded values in one scan
     string replaceAliases(const string & s);
-    string replaceAliases(const string & s, unsigned int index, const string & value);
 
 } // namespace constants
 
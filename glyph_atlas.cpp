@@ -0,0 +1,107 @@
+#include "glyph_atlas.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "global.h"
+
+using std::cerr, std::endl;
+
+namespace {
+    // SDL_ttf glyph functions take UCS-2 characters
+    Uint16 toUCS2(Uint32 codepoint) {
+        return codepoint > 0xFFFF ? 0xFFFD : static_cast<Uint16>(codepoint);
+    }
+}
+
+GlyphAtlas::GlyphAtlas(TTF_Font *font)
+    : font_(font), height_(TTF_FontHeight(font))
+{
+}
+
+const Glyph & GlyphAtlas::getGlyph(Uint32 codepoint)
+{
+    auto it = glyphs_.find(codepoint);
+    if (it != glyphs_.end()) return it->second;
+
+    Glyph glyph;
+    Uint16 ch = toUCS2(codepoint);
+    int minx, maxx, miny, maxy;
+    if (TTF_GlyphMetrics(font_, ch, &minx, &maxx, &miny, &maxy, &glyph.advance) != 0)
+        glyph.advance = 0;
+
+    // render glyph in white, text color is applied by color mod on render
+    SDL_Color white = {255, 255, 255, 255};
+    SDLSurfaceUniquePtr surface { TTF_RenderGlyph_Blended(font_, ch, white) };
+    if (surface != nullptr && surface->w > 0 && surface->h > 0) {
+        if (!addToPage(surface.get(), glyph))
+            cerr << "cannot add glyph to atlas: " << codepoint << endl;
+    }
+
+    return glyphs_.emplace(codepoint, glyph).first->second;
+}
+
+int GlyphAtlas::getKerning(Uint32 previous, Uint32 codepoint) const
+{
+    return TTF_GetFontKerningSizeGlyphs(font_, toUCS2(previous), toUCS2(codepoint));
+}
+
+bool GlyphAtlas::addToPage(SDL_Surface *surface, Glyph &glyph)
+{
+    // keep a gap between glyphs to avoid bleeding when scaled
+    const int padding = 1;
+    int w = surface->w + padding;
+    int h = surface->h + padding;
+    if (w > PAGE_SIZE || h > PAGE_SIZE) return false;
+
+    // start a new shelf when the current one is full
+    if (shelfX_ + w > PAGE_SIZE) {
+        shelfX_ = 0;
+        shelfY_ += shelfHeight_;
+        shelfHeight_ = 0;
+    }
+
+    // start a new page when no shelf is left
+    if (pages_.empty() || shelfY_ + h > PAGE_SIZE) addPage();
+    if (pages_.back() == nullptr) return false;
+
+    // upload glyph pixels
+    SDLSurfaceUniquePtr converted;
+    if (surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        converted.reset(SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0));
+        if (converted == nullptr) return false;
+        surface = converted.get();
+    }
+    SDL_Rect rect = {shelfX_, shelfY_, surface->w, surface->h};
+    if (SDL_UpdateTexture(pages_.back().get(), &rect, surface->pixels, surface->pitch) != 0)
+        return false;
+
+    glyph.page = pages_.back().get();
+    glyph.src = rect;
+
+    shelfX_ += w;
+    shelfHeight_ = std::max(shelfHeight_, h);
+    return true;
+}
+
+void GlyphAtlas::addPage()
+{
+    SDLTextureUniquePtr page {
+        SDL_CreateTexture(
+            global::renderer,
+            SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STATIC,
+            PAGE_SIZE, PAGE_SIZE)
+    };
+    if (page == nullptr) {
+        cerr << "Glyph atlas creation failed" << endl;
+    } else {
+        // clear page so that padding is transparent
+        vector<Uint32> pixels(static_cast<size_t>(PAGE_SIZE * PAGE_SIZE), 0);
+        SDL_UpdateTexture(page.get(), nullptr, pixels.data(), PAGE_SIZE * 4);
+        SDL_SetTextureBlendMode(page.get(), SDL_BLENDMODE_BLEND);
+    }
+
+    pages_.push_back(std::move(page));
+    shelfX_ = shelfY_ = shelfHeight_ = 0;
+}
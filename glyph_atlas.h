@@ -0,0 +1,49 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <map>
+#include <vector>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "sdl_unique_ptr.h"
+
+using std::map;
+using std::vector;
+
+struct Glyph
+{
+    SDL_Texture *page = nullptr;    // atlas page, null for glyphs without pixels
+    SDL_Rect src = {0, 0, 0, 0};    // glyph area in atlas page
+    int advance = 0;
+};
+
+class GlyphAtlas
+{
+public:
+    explicit GlyphAtlas(TTF_Font *font);
+
+    // disallow copying and assignment
+    GlyphAtlas(const GlyphAtlas &) = delete;
+    GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+    // get glyph of codepoint, rasterize into atlas on first use
+    const Glyph & getGlyph(Uint32 codepoint);
+    int getKerning(Uint32 previous, Uint32 codepoint) const;
+    int getHeight() const { return height_; }
+
+private:
+    static const int PAGE_SIZE = 1024;
+
+    bool addToPage(SDL_Surface *surface, Glyph &glyph);
+    void addPage();
+
+    TTF_Font *font_;
+    int height_;
+    map<Uint32, Glyph> glyphs_;
+    vector<SDLTextureUniquePtr> pages_;
+    int shelfX_ = 0, shelfY_ = 0, shelfHeight_ = 0;
+};
+
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,76 @@
+#include "glyph_text.h"
+
+#include <cmath>
+
+#include "global.h"
+
+namespace {
+    // glyphs are rasterized at double font size like TextTexture
+    const double SCALE = 0.5;
+
+    // decode next UTF-8 codepoint and advance position
+    Uint32 nextCodepoint(const string & s, size_t & pos) {
+        auto byte = [&s](size_t i) { return static_cast<Uint32>(static_cast<unsigned char>(s[i])); };
+
+        Uint32 c = byte(pos++);
+        int extra = 0;
+        if (c >= 0xF0) { c &= 0x07; extra = 3; }
+        else if (c >= 0xE0) { c &= 0x0F; extra = 2; }
+        else if (c >= 0xC0) { c &= 0x1F; extra = 1; }
+        else if (c >= 0x80) return 0xFFFD;
+
+        while (extra-- > 0) {
+            if (pos >= s.length() || (byte(pos) & 0xC0) != 0x80) return 0xFFFD;
+            c = (c << 6) | (byte(pos++) & 0x3F);
+        }
+        return c;
+    }
+}
+
+GlyphText::GlyphText(const string & text, GlyphAtlas *atlas, SDL_Color color,
+    TextureAlignment alignment)
+    : text_(text), color_(color)
+{
+    ProfileScope profileScope(ProfilePhase::textures);
+
+    // lay out glyphs on one line
+    int x = 0;
+    Uint32 previous = 0;
+    size_t pos = 0;
+    while (pos < text_.length()) {
+        Uint32 codepoint = nextCodepoint(text_, pos);
+        if (previous != 0) x += atlas->getKerning(previous, codepoint);
+
+        const Glyph & glyph = atlas->getGlyph(codepoint);
+        if (glyph.page != nullptr) quads_.push_back({ &glyph, x });
+
+        x += glyph.advance;
+        previous = codepoint;
+    }
+
+    init(
+        static_cast<int>(x * SCALE),
+        static_cast<int>(atlas->getHeight() * SCALE),
+        alignment
+    );
+}
+
+void GlyphText::renderRect(const SDL_Rect &rect) const
+{
+    SDL_Texture *page = nullptr;
+    for (const auto &quad : quads_) {
+        if (quad.glyph->page != page) {
+            page = quad.glyph->page;
+            SDL_SetTextureColorMod(page, color_.r, color_.g, color_.b);
+            SDL_SetTextureAlphaMod(page, color_.a);
+        }
+
+        SDL_Rect dst = {
+            rect.x + static_cast<int>(std::lround(quad.x * SCALE)),
+            rect.y,
+            static_cast<int>(std::lround(quad.glyph->src.w * SCALE)),
+            static_cast<int>(std::lround(quad.glyph->src.h * SCALE))
+        };
+        SDL_RenderCopy(global::renderer, page, &quad.glyph->src, &dst);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef GLYPH_TEXT_H
+#define GLYPH_TEXT_H
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+
+#include "texture_base.h"
+#include "glyph_atlas.h"
+
+using std::string;
+using std::vector;
+
+// single line text drawn from glyph atlas, creating one only lays out glyphs
+class GlyphText: public TextureBase
+{
+public:
+    explicit GlyphText(const string & text, GlyphAtlas *atlas, SDL_Color color, 
+        TextureAlignment alignment = TextureAlignment::topLeft);
+    virtual ~GlyphText() = default;
+
+    // disallow copying and assignment
+    GlyphText(const GlyphText &) = delete;
+    GlyphText &operator=(const GlyphText &) = delete;
+
+    const string & getText() const { return text_; }
+
+protected:
+    void renderRect(const SDL_Rect &rect) const override;
+
+private:
+    struct GlyphQuad {
+        const Glyph *glyph;
+        int x;
+    };
+
+    const string text_;
+    const SDL_Color color_;
+    vector<GlyphQuad> quads_;
+};
+
+#endif // GLYPH_TEXT_H
@@ -14,24 +14,30 @@
 #include "fileutils.h"
 #include "setting_item.h"
 #include "setting_group.h"
+#include "settings_file.h"
+#include "shell_batch.h"
+#include "process_runner.h"
 #include "image_texture.h"
 #include "text_texture.h"
+#include "glyph_atlas.h"
+#include "glyph_text.h"
 
 using std::string;
 using std::cout, std::cerr, std::endl;
-using std::istream, std::ostream, std::getline;
-using std::ifstream, std::ofstream;
-using std::istringstream, std::ostringstream;
+using std::ostringstream;
 using std::quoted;
 using std::vector;
+using std::string_view;
 
 // global variables used in main.cpp
-string programName;
+using global::programName;
+using global::printErrorAndExit;
 string configFileName;
 int fontSize = 28;
-vector<SettingGroup*> settingGroups = { new SettingGroup("Default") };
+vector<SettingGroup*> settingGroups;
 unsigned int selectedGroupIndex = 0;
 SDL_Texture *messageBGTexture = nullptr;
+SDL_Texture *screenTexture = nullptr;
 SDL_Rect overlay_bg_render_rect;
 string titleText = "";
 string instructionText = "\u24B6 Change  \u24B7 Save & Exit  [Select] Cancel";
@@ -43,89 +49,31 @@ TextTexture* prevTexture = nullptr;
 TextTexture* nextTexture = nullptr;
 TextTexture* buttonLTexture = nullptr;
 TextTexture* buttonRTexture = nullptr;
-TextTexture* groupNameTexture = nullptr;
-TextTexture* itemIndexTexture = nullptr;
+GlyphText* groupNameTexture = nullptr;
+GlyphText* itemIndexTexture = nullptr;
 ImageTexture* toggleOnTexture = nullptr;
 ImageTexture* toggleOffTexture = nullptr;
 ImageTexture* runOnTexture = nullptr;
 ImageTexture* runOffTexture = nullptr;
 bool isShowTitle = false;
 bool isShowSinglePage = false;
+bool isGenerateOptionsOnly = false;
+bool isUseConfigCache = false;
+bool isUseSingleShell = false;
+bool isFramePresented = false;
+int headlessFrameCount = 0;
+string screenshotFilename;
+bool isRedrawNeeded = true;
+bool hasIdleWork = true;
+unsigned int idleGroupIndex = 0, idleItemIndex = 0;
+unsigned int scrollFromGroupIndex = 0;
+int scrollDirection = 0;
+Uint32 scrollStartTicks = 0;
+const Uint32 SCROLL_DURATION = 450;
+int idleWaitTimeout = 1000;
+Uint32 idleWorkBudget = 4;
 
 namespace {
-    class BracketedString {
-    public:
-        BracketedString(string &s) : str(s), const_str(s) {};
-        BracketedString(const string &s) : const_str(s) {};
-
-        friend istream & operator>>(istream &is, BracketedString bs) {
-            if (&bs.str == &BracketedString::dummy) 
-                throw std::invalid_argument("not lvalue");
-            
-            // if not start with open bracket, treat as usual input case
-            char ch;
-            is >> ch;
-            if (ch != '[') { is.putback(ch); return is >> bs.str; }
-
-            is >> std::noskipws; // disable skipping white space
-            bs.str.clear(); // clear output string first
-
-            // read characters until close bracket is found
-            ostringstream oss;
-            bool isEscaped = false;
-            while (is >> ch) {
-                if (isEscaped) { isEscaped = false; oss << ch; continue; }
-                if (ch == '\\') { isEscaped = true; continue; }
-                if (ch == ']') break;
-                oss << ch;
-            }
-            bs.str = oss.str();
-
-            return is >> std::skipws; // enable skipping white space and return
-        }
-
-        friend ostream & operator<<(ostream &os, BracketedString bs) {
-            os << '[';
-            for(const char& ch : bs.const_str) { 
-                if (ch == ']') os << '\\'; 
-                os << ch; 
-            } 
-            os << ']';
-            return os;
-        }
-
-    private:
-        static string dummy;
-        string &str = dummy;
-        const string &const_str;
-    };
-
-    string BracketedString::dummy;
-
-    BracketedString bracketed(string & s) {
-        return BracketedString(s);
-    }
-
-    BracketedString bracketed(const string & s) {
-        return BracketedString(s);
-    }
-
-	// trim from start (in place)
-	inline void ltrim(string &s) {
-		s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
-			return !std::isspace(ch);
-		}));
-	}
-
-	// trim from end (in place)
-	inline void rtrim(string &s) {
-		s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) {
-			return !std::isspace(ch);
-		}).base(), s.end());
-	}
-
-    // istream & operator>>(istream &is, string& s)
-
 	double easeInOutQuart(double x)
 	{
 		return x < 0.5 ? 8 * x * x * x * x : 1 - pow(-2 * x + 2, 4) / 2;
@@ -134,17 +82,24 @@ namespace {
     void printUsage()
     {
         cout << R"_(
-Usage: easyConfig config_file [-t title] [-p index] [-o]
+Usage: easyConfig config_file [-t title] [-p index] [-o] [-c] [-s] [--profile csv_file] [--trace json_file]
+                  [--headless frames] [--screenshot png_file]
 
 -t:     title of the config window.
 -p:     show i-th group only (first group index = 1).
 -o:     generate options only
+-c:     use compiled cache of config file (config_file.cache)
+-s:     run commands of changed settings one by one in a single shell, each in a subshell
+--profile:      write frame timings to csv file and print summary on exit.
+--trace:        write startup, command and save timeline to json file for chrome://tracing.
+--headless:     render frames of each group offscreen with software renderer, print frame costs and exit.
+--screenshot:   write last rendered screen to png file, implies --headless 1 if not given.
 -h,--help       show this help message.
 
-UI control: L1/R1: Select group, Up/Down: Select item, Left/Right/A: Change value, B: Save and exit, Select: Cancel and exit
+UI control: L1/R1: Select group, Up/Down: Select item, Left/Right/A: Change value, B: Save and exit, Select: Cancel and exit, Y: Show frame timings
 
 The config file should contains lines of config settings, in the following format:
-"NAME" "DESCRIPTION" "POSSIBLE_VALUES" "DISPLAY_VALUES" "CURRENT_VALUE" ["COMMANDS"] ["UPDATE_COMMAND"]
+"NAME" "DESCRIPTION" "POSSIBLE_VALUES" "DISPLAY_VALUES" "CURRENT_VALUE" ["COMMANDS"] ["UPDATE_COMMAND"] ["FLAGS"]
 
 NAME: short name used in options file.
 DESCRIPTION: description shown in config window.
@@ -153,6 +108,7 @@ DISPLAY_VALUES: corresponding display texts of possible values shown in config w
 CURRENT_VALUES: current value of setting, should be one of the display values.
 COMMANDS: optional commands to be executed on exit if the setting value is changed.
 UPDATE_COMMAND: optional command to be executed to update the minor text on setting value is changed.
+FLAGS: optional flags of setting item seperated by '|'.
 
 POSSIBLE_VALUES, DISPLAY_VALUES and COMMANDS are values seperated by '|'. Example lines of config file:
 
@@ -167,12 +123,20 @@ If there is only one command in COMMANDS field, this will be general command and
 
 If UPDATE_COMMAND exists, it will be executed when the corresponding setting value is changed by user. The command should print new information to stdout to update the minor text.
 
+Output of UPDATE_COMMAND is cached for each value during the session. Add flag nocache to run the command every time for commands depending on other system states.
+
+COMMANDS of changed settings are run in parallel on exit. Add flag order=KEY to settings whose commands depend on each other, commands of settings with the same KEY are run one by one in config file order.
+
+Commands for CURRENT_VALUE, UPDATE_COMMAND and information texts are killed after 10 seconds, and a placeholder text is shown instead of their output. Add flag timeout=SECONDS to change the time limit of a setting, 0 means no limit. A setting whose CURRENT_VALUE command timed out cannot be changed, its commands are not run, and its option already in the options file is kept.
+
 You can define alias in the begining of the config file and use them to represent long commands in fields CURRENT_VALUE, COMMANDS and UPDATE_COMMAND. To define an alias insert line with the following format:
 
 $ALIAS_NAME=long string to replaced$
 
 And to use the alias in a command replace the string to be replaced with the syntex $ALIAS_NAME$. Also you can use predefined alias _VALUE_ and _INDEX_ to represent the current selected value and its zero-based index of the setting item.
 
+An alias value can use other aliases, written with escaped dollar signs, e.g. $SCRIPT=\$DIR\$/x.sh$. They are expanded when the config file is loaded, in any order of definition. An alias used within its own value is left as it is.
+
 Dynamic information text can be added as single item, which should be a command to be executed on start. The command should print output to stdout to set the information text. To define an information text add a line with the following format
 
 %"the_commond_to_run_on_start.sh"
@@ -190,16 +154,6 @@ Config file is updated with new values when program exit.
 )_";
     }
 
-    void printErrorAndExit(string message, string extraMessage = "")
-	{
-		cerr << programName << ": " << message;
-		if (!extraMessage.empty())
-			cerr << extraMessage;
-		cerr << endl
-			 << endl;
-		exit(0);
-	}
-
 	void printErrorUsageAndExit(string message, string extraMessage = "")
     {
 		cerr << programName << ": " << message;
@@ -212,270 +166,111 @@ Config file is updated with new values when program exit.
 
 	void loadConfigFile(const char *filename)
     {
-        // set enivornment variable
-        setenv("IS_LOADING", "true", 1);
-
-		// open file
-		ifstream file;
-		file.open(filename);
-
-		if (!file.is_open()) printErrorAndExit("cannot open file: ", filename);
-
-        // iterate all input line
-        string line;
-        SettingItem * lastItem = nullptr;
-        while (getline(file, line))
-        {
-            // trim input line
-            rtrim(line);
-            ltrim(line);
-
-            // skip empty line
-            if (line.empty()) continue;
-
-            // skip line start with '#'
-            if (line.front() == '#') continue;
-
-            // handle alias
-            if (line.front() == '$') {
-                istringstream iss(line);
-                string pair;
-                if (! (iss >> quoted(pair, '$'))) 
-                    printErrorAndExit("cannot process line1: ", line);
-
-                auto pos = pair.find("=");
-                if (pos == string::npos || pos == 0 || pos >= pair.length() - 1)
-                    printErrorAndExit("cannot process line2: ", line);
-
-                string name = '$' + pair.substr(0, pos) + '$';
-                string value = pair.substr(pos + 1);
-                global::aliases[name] = value;
-                cout << name << ' ' << value << endl;
-                continue;
-            }
-
-            // try read line as setting group
-            if (line.front() == '[') {
-                istringstream iss(line);
-                string groupName, outputFilename;
-
-                // read group name
-                if (! (iss >> bracketed(groupName))) 
-                    printErrorAndExit("cannot process line: ", line);
-
-                // try read output filename
-                iss >> bracketed(outputFilename);
-
-                // create group item
-                settingGroups.push_back(new SettingGroup(groupName, outputFilename));
-
-                continue;
-            }
-
-            // handle minor text
-            if (line.front() == '@') {
-                // skip first character
-                string s = line;
-                s.erase(s.begin());
-
-                istringstream iss(s);
-                string minorText;
-                iss >> quoted(minorText);
-
-                if (minorText.empty() || lastItem == nullptr)
-                    printErrorAndExit("cannot process line: ", line);
-
-                lastItem->setMinorText(minorText);
-
-                continue;
-            }
-
-            // handle info text
-            if (line.front() == '%') {
-                // skip first character
-                string s = line;
-                s.erase(s.begin());
-
-                istringstream iss(s);
-                string infoCommand;
-                iss >> quoted(infoCommand);
-
-                if (infoCommand.empty())
-                    printErrorAndExit("cannot process line: ", line);
-
-                // create setting item
-                auto item = new SettingItem(infoCommand);
-
-                if (item->IsInitOK() == false) {
-                    printErrorAndExit(item->getErrorMessage() + ": ", line);
-                }
-
-                // add item to recent created group
-                settingGroups.back()->getItems().push_back(item);
-
-                // store last item
-                lastItem = item;
-
-                continue;
-            }
-
-            // process line with string stream
-            // try read line as setting item
-            string id, description, options, displayValues, selectedValue;
-            istringstream iss(line);
-            if (! (iss >> quoted(id) 
-                >> quoted(description) 
-                >> quoted(options)
-                >> quoted(displayValues)
-                >> quoted(selectedValue)))
-            {
-                printErrorAndExit("cannot process line: ", line);
-            }
-
-            // try read commands
-            string commands, infoCommand;
-            iss >> quoted(commands) >> quoted(infoCommand);
-
-            // create setting item
-            auto item = new SettingItem(
-                id, 
-                description, 
-                options,
-                displayValues, 
-                selectedValue,
-                commands,
-                infoCommand
-            );
-
-            if (item->IsInitOK() == false) {
-                printErrorAndExit(item->getErrorMessage() + ": ", line);
-            }
-
-            // add item to recent created group
-            settingGroups.back()->getItems().push_back(item);
-
-            // store last item
-            lastItem = item;
-        }
-
-		// close file
-		file.close();
-
-        // remove default empty group
-        if (settingGroups.front()->getSize() == 0)
-        {
-            settingGroups.erase(settingGroups.begin());
-        }
+        settingGroups = loadSettingsFile(filename, isUseConfigCache);
 
         // adjust selectedGroupIndex
         if (selectedGroupIndex >= settingGroups.size()) 
         { 
             selectedGroupIndex = settingGroups.size() - 1;
         }
-
-        // set enivornment variable
-        setenv("IS_LOADING", "false", 1);
     }
 
     void saveConfigFile(const string &filename) {
-		// open file
-		ofstream file;
-		file.open(filename);
+        saveSettingsFile(filename, settingGroups, isUseConfigCache);
+    }
 
-        // exit if file cannot open
-        if (!file.is_open()) printErrorAndExit("cannot open file: ", filename);
+    void saveOptionsFile()
+    {
+        saveOptionFiles(settingGroups);
+    }
 
-        // write all alias to file
-        for (const auto& [key, value] : global::aliases)
-        {
-            string key_ = key;
-            key_ = key.substr(1, key.length() - 2);
+    // add init span from start until now to trace
+    void traceSince(const char *name, long long start) {
+        if (global::tracer.isEnabled())
+            global::tracer.addSpan(name, "init", start, global::tracer.now() - start);
+    }
 
-            file << quoted(key_ + '=' + value, '$') << endl;
+    // draw frame timings on top of settings
+    void renderProfileOverlay() {
+        if (!global::profiler.isOverlayShown()) return;
+
+        auto lines = global::profiler.getSummaryLines();
+        int lineHeight = global::glyphAtlas->getHeight() / 2;
+        SDL_Rect rect = {0, 0, global::LOGICAL_WIDTH, lineHeight * static_cast<int>(lines.size()) + 8};
+        SDL_SetRenderDrawBlendMode(global::renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(global::renderer, 0, 0, 0, 200);
+        SDL_RenderFillRect(global::renderer, &rect);
+
+        int y = 4;
+        for (const auto &line : lines) {
+            GlyphText text(line, global::glyphAtlas, global::text_color);
+            text.render(8, y);
+            y += lineHeight;
         }
+    }
 
-        // write all settings to file
-        for (auto &group : settingGroups)
-        {
-            file << bracketed(group->getName());
-            if (!group->getOutputFilename().empty())
-               file << ' ' << bracketed(group->getOutputFilename());
-            file << endl;
-            for (auto &item : group->getItems())
-            {
-                // handle info text
-                if (item->isInfoText()) {
-                    file << '%' << quoted(item->getCommandsString()) << endl;
-
-                // handle normal setting item
-                } else {
-                    file << quoted(item->getID()) << ' '
-                        << quoted(item->getDescription()) << ' '
-                        << quoted(item->getOptionsString()) << ' '
-                        << quoted(item->getDisplayValuesString_()) << ' ';
-                        
-                    if (!item->getSourceCommandString().empty())
-                        file << quoted(item->getSourceCommandString());
-                    else
-                        file << quoted(item->getSelectedValue());
+    // start drawing a frame to the landscape screen texture
+    void beginFrame() {
+        SDL_SetRenderTarget(global::renderer, screenTexture);
+        SDL_SetRenderDrawColor(global::renderer, 40, 40, 40, 255);
+        SDL_RenderClear(global::renderer);
+    }
 
-                    // if (!item->getCommandsString().empty())
-                        file << ' ' << quoted(item->getCommandsString());
+    // rotate the screen texture to the portrait display
+    void drawScreen() {
+        SDL_SetRenderTarget(global::renderer, nullptr);
+        SDL_Rect rect = {
+            (global::SCREEN_WIDTH - global::LOGICAL_WIDTH) / 2,
+            (global::SCREEN_HEIGHT - global::LOGICAL_HEIGHT) / 2,
+            global::LOGICAL_WIDTH,
+            global::LOGICAL_HEIGHT
+        };
+        SDL_RenderCopyEx(global::renderer, 
+            screenTexture, 
+            nullptr, 
+            &rect,
+            270, nullptr, SDL_FLIP_NONE
+        );
+    }
 
-                    // if (!item->getInfoCommandString().empty())
-                        file << ' ' << quoted(item->getInfoCommandString());
+    // draw the screen texture and present it
+    void presentFrame() {
+        ProfileScope profileScope(ProfilePhase::present);
 
-                    file << endl;
+        drawScreen();
 
-                    if (!item->getMinorText().empty())
-                        file << '@' << quoted(item->getMinorText()) << endl;
-                }
-            }
+        // first present shows when the screen appears
+        if (!isFramePresented) {
+            TraceScope traceScope("first present", "render");
+            SDL_RenderPresent(global::renderer);
+            isFramePresented = true;
+        } else {
+            SDL_RenderPresent(global::renderer);
         }
-
-		// close file
-		file.close();
     }
 
-    void saveOptionsFile()
+    void printCommandFailure(const string &command, int exitStatus,
+        std::chrono::milliseconds wallTime = std::chrono::milliseconds::zero())
     {
-        // write all settings to file
-        for (auto &group : settingGroups)
-        {
-            // get filename, skip this group if empty
-            auto filename = group->getOutputFilename();
-            if (filename.empty()) continue;
-
-            // open file
-            ofstream file;
-            file.open(filename);
-
-            // skip this group if file cannot open
-            if (!file.is_open()) { 
-                cerr << "cannot open file: " << filename << endl;
-                continue;
-            }
-
-            for (auto &item : group->getItems())
-            {
-                auto id = item->getID();
-                auto opt = item->getOptions()[item->getSelectedIndex()];
-                if (id.empty() && opt.empty()) continue;
-                file << id << ' ' << opt;
-                if (item != group->getItems().back()) file << ' ';
-            }
-
-            // close file
-            file.close();
-        }
+        // one write, commands may fail on several workers at once
+        string time = wallTime.count() > 0 ? " after " + std::to_string(wallTime.count()) + " ms" : "";
+        cerr << programName + ": command failed (" + std::to_string(exitStatus) + ")" + time + ": " +
+            command + "\n";
     }
 
     void runCommands() {
+        TraceScope traceScope("runCommands", "apply");
+
         // render setting items
-        SDL_SetRenderDrawColor(global::renderer, 40, 40, 40, 255);
-        SDL_RenderClear(global::renderer);
+        beginFrame();
         applyingSettingsTexture->render();
-        SDL_RenderPresent(global::renderer);
+        presentFrame();
+
+        // commands of items with the same order key form one chain,
+        // other items get a chain of their own
+        vector<vector<string>> chains;
+        map<string, size_t> chainIndexes;
+        vector<string> commandsInOrder;
 
         // scan all setting items
         for (auto &group : settingGroups)
@@ -485,9 +280,9 @@ Config file is updated with new values when program exit.
                 // skep info text item
                 if (item->isInfoText()) continue;
 
-                auto commands = item->getCommands();
+                const auto &commands = item->getCommandTemplates();
                 auto index = item->getSelectedIndex();
-                auto value = item->getSelectedValue();
+                const auto &value = item->getSelectedValue();
 
                 // skip item if no command provided
                 if (commands.size() == 0) continue;
@@ -496,18 +291,50 @@ Config file is updated with new values when program exit.
                 if (index == item->getOldSelectedIndex()) continue;
 
                 // get corresponding command
-                string cmd = commands[0];
+                const CommandTemplate *command = &commands[0];
                 if (commands.size() > index) {
-                    cmd = commands[index];
+                    command = &commands[index];
+                }
+
+                // find chain of the item
+                const auto &orderKey = item->getOrderKey();
+                size_t chainIndex = chains.size();
+                if (!orderKey.empty()) {
+                    chainIndex = chainIndexes.emplace(orderKey, chains.size()).first->second;
                 }
+                if (chainIndex == chains.size()) chains.emplace_back();
+
+                // fill in index and value
+                chains[chainIndex].push_back(command->expand(index, value));
+                commandsInOrder.push_back(chains[chainIndex].back());
+            }
+        }
 
-                // replace aliases with corresponding values
-                cmd = global::replaceAliases(cmd, index, value);
+        // nothing changed, do not start any shell
+        if (commandsInOrder.empty()) return;
 
-                // run the command
-                system(cmd.c_str());
+        // run all commands one by one in one shell process, in config order
+        if (isUseSingleShell) {
+            ShellBatch shell;
+            for (const auto &cmd : commandsInOrder) {
+                int status = shell.run(cmd);
+                if (status != 0) printCommandFailure(cmd, status);
             }
+            return;
         }
+
+        // run chains on command workers, exit after the slowest one
+        vector<std::future<void>> runningChains;
+        for (auto &chain : chains) {
+            runningChains.push_back(global::commandPool.submit([commands = std::move(chain)]() {
+                for (const auto &cmd : commands) {
+                    auto result = runProcess(cmd);
+                    if (result.exitStatus != 0)
+                        printCommandFailure(cmd, result.exitStatus, result.wallTime);
+                }
+            }));
+        }
+        for (auto &running : runningChains) running.wait();
     }
 
 	void handleOptions(int argc, char *argv[])
@@ -550,9 +377,47 @@ Config file is updated with new values when program exit.
             }
             else if (strcmp(option, "-o") == 0)
             {
-                loadConfigFile(argv[1]);
-                saveOptionsFile();
-                exit(0);
+                isGenerateOptionsOnly = true;
+                i++;
+            }
+            else if (strcmp(option, "-c") == 0)
+            {
+                isUseConfigCache = true;
+                i++;
+            }
+            else if (strcmp(option, "-s") == 0)
+            {
+                isUseSingleShell = true;
+                i++;
+            }
+            else if (strcmp(option, "--trace") == 0)
+            {
+				if (i == argc - 1) printErrorUsageAndExit("--trace: Missing option value");
+                if (!global::tracer.open(argv[i+1]))
+                    printErrorAndExit("cannot open file: ", argv[i+1]);
+                i += 2;
+            }
+            else if (strcmp(option, "--headless") == 0)
+            {
+				if (i == argc - 1) printErrorUsageAndExit("--headless: Missing option value");
+                headlessFrameCount = atoi(argv[i+1]);
+                if (headlessFrameCount <= 0) printErrorUsageAndExit("--headless: Invalid frame count");
+                i += 2;
+            }
+            else if (strcmp(option, "--screenshot") == 0)
+            {
+				if (i == argc - 1) printErrorUsageAndExit("--screenshot: Missing option value");
+                screenshotFilename = argv[i+1];
+                if (screenshotFilename.empty()) printErrorUsageAndExit("--screenshot: Filename can't be empty");
+                if (headlessFrameCount == 0) headlessFrameCount = 1;
+                i += 2;
+            }
+            else if (strcmp(option, "--profile") == 0)
+            {
+				if (i == argc - 1) printErrorUsageAndExit("--profile: Missing option value");
+                if (!global::profiler.openCsvFile(argv[i+1]))
+                    printErrorAndExit("cannot open file: ", argv[i+1]);
+                i += 2;
             }
 			else
 				printErrorUsageAndExit("Invalue option: ", option);
@@ -572,9 +437,10 @@ Config file is updated with new values when program exit.
             }
         }
 
-        groupNameTexture = new TextTexture(
+        delete groupNameTexture;
+        groupNameTexture = new GlyphText(
             oss.str(),
-            global::font,
+            global::glyphAtlas,
             global::text_color,
             TextureAlignment::topCenter
         );
@@ -584,9 +450,10 @@ Config file is updated with new values when program exit.
         ostringstream oss;
         auto group = settingGroups[selectedGroupIndex];
         oss << group->getSelectedIndex() + 1 << '/' << group->getSize();
-        itemIndexTexture = new TextTexture(
+        delete itemIndexTexture;
+        itemIndexTexture = new GlyphText(
             oss.str(),
-            global::font,
+            global::glyphAtlas,
             global::text_color,
             TextureAlignment::bottomRight
         );
@@ -594,17 +461,29 @@ Config file is updated with new values when program exit.
 
 	void prepareTextures()
 	{
+		TraceScope traceScope("prepareTextures", "texture");
+
+		// create landscape screen texture, rotated once on present
+		screenTexture = SDL_CreateTexture(
+			global::renderer,
+			SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_TARGET,
+			global::LOGICAL_WIDTH,
+			global::LOGICAL_HEIGHT);
+		if (screenTexture == nullptr)
+			printErrorAndExit("Screen texture creation failed: ", SDL_GetError());
+
 		// create message overlay background texture
 		int overlay_height = fontSize * 2;
-		SDL_Rect overlay_bg_rect = {0, 0, overlay_height, global::SCREEN_HEIGHT};
+		SDL_Rect overlay_bg_rect = {0, 0, global::LOGICAL_WIDTH, overlay_height};
 		overlay_bg_render_rect.x = 0;
 		overlay_bg_render_rect.y = 0;
-		overlay_bg_render_rect.w = overlay_height;
-		overlay_bg_render_rect.h = global::SCREEN_HEIGHT;
+		overlay_bg_render_rect.w = global::LOGICAL_WIDTH;
+		overlay_bg_render_rect.h = overlay_height;
 		SDL_Surface *surfacebg = SDL_CreateRGBSurface(
 			0,
+			global::LOGICAL_WIDTH,
 			overlay_height,
-			global::SCREEN_HEIGHT,
 			32, 0, 0, 0, 0);
 		SDL_FillRect(
 			surfacebg,
@@ -675,7 +554,35 @@ Config file is updated with new values when program exit.
         );
     }
 
-    void renderAllSettings(int offsetX=0, bool isShowHighlight=true, bool isShowInstruction=true)
+    // fill value text caches of displayed items while screen is idle,
+    // return true if there is more work left
+    bool prepareIdleTextures() {
+        Uint32 start = SDL_GetTicks();
+        while (idleGroupIndex < settingGroups.size()) {
+            auto &items = settingGroups[idleGroupIndex]->getItems();
+            if (idleItemIndex >= items.size()) {
+                idleGroupIndex++;
+                idleItemIndex = 0;
+                continue;
+            }
+            if (!items[idleItemIndex]->prepareNextValueTexture()) {
+                idleItemIndex++;
+                continue;
+            }
+            if (SDL_GetTicks() - start >= idleWorkBudget) return true;
+        }
+        return false;
+    }
+
+    // items create textures when they first come into view,
+    // scan again for value texts of the new items in idle time
+    void onItemTexturesCreated() {
+        hasIdleWork = true;
+        idleGroupIndex = idleItemIndex = 0;
+    }
+
+    void renderAllSettings(unsigned int groupIndex, int offsetX=0, bool isShowHighlight=true,
+        bool isShowInstruction=true)
     {
         int marginTop = 60;
         int marginLeft = 20;
@@ -705,35 +612,31 @@ Config file is updated with new values when program exit.
         }
 
         // get some display parameters
-        auto group = settingGroups[selectedGroupIndex];
+        auto group = settingGroups[groupIndex];
         unsigned int selectedItemIndex = group->getSelectedIndex();
-        unsigned int topItemIndex = group->getDisplayTopIndex();
-        if (topItemIndex > selectedItemIndex) topItemIndex = selectedItemIndex;
-
-        // adjust top item to display
-        int totalHeight = marginTop;
-        for (unsigned int i=topItemIndex; i<=selectedItemIndex; i++)
-            totalHeight += group->getItems()[i]->getHeight();
+        int listHeight = global::LOGICAL_HEIGHT - instructionTexture->getHeight() - marginTop;
 
-        if (totalHeight > global::SCREEN_WIDTH - instructionTexture->getHeight()) topItemIndex++;
+        // measure items up to selected one, and scroll so it is visible
+        if (group->updateLayout(selectedItemIndex)) onItemTexturesCreated();
+        unsigned int topItemIndex = group->findTopIndex(
+            group->getDisplayTopIndex(), selectedItemIndex, listHeight);
         group->setDisplayTopIndex(topItemIndex);
 
-        // iterate and render all items within the screen
-        unsigned int index = 0;
-        int offsetY = marginTop;
-        auto items = group->getItems();
-        for (auto &item : items)
+        // iterate and render items within the screen only
+        const auto &items = group->getItems();
+        for (unsigned int index = topItemIndex; index < items.size(); index++)
         {
-            // skip items that are outside screen
-            if (index < topItemIndex) { index++; continue; };
-            if (offsetY + item->getHeight() > global::SCREEN_WIDTH - instructionTexture->getHeight()) break;
+            if (group->updateLayout(index)) onItemTexturesCreated();
+            if (group->getItemBottom(index) - group->getItemTop(topItemIndex) > listHeight) break;
+            auto item = items[index];
+            int offsetY = marginTop + group->getItemTop(index) - group->getItemTop(topItemIndex);
 
             // render background if it is selected
             if (index == selectedItemIndex && isShowHighlight)
             {
                 auto rect = overlay_bg_render_rect;
-                rect.x += offsetY;// - fontSize / 4;
-                rect.w = item->getHeight();
+                rect.y += offsetY;// - fontSize / 4;
+                rect.h = item->getHeight();
                 SDL_RenderCopy(global::renderer, messageBGTexture, nullptr, &rect);
             }
 
@@ -745,7 +648,7 @@ Config file is updated with new values when program exit.
             {
                 if (item->isOnOffSetting())
                 {
-                    int x = offsetX + global::SCREEN_HEIGHT - marginRight;
+                    int x = offsetX + global::LOGICAL_WIDTH - marginRight;
                     x -= toggleOnTexture->getWidth();
                     int y = offsetY + (item->getHeight() - toggleOnTexture->getHeight()) / 2;
                     if (item->getSelectedIndex() == 0)
@@ -755,7 +658,7 @@ Config file is updated with new values when program exit.
                 }
                 else if (item->isRunOffSetting())
                 {
-                    int x = offsetX + global::SCREEN_HEIGHT - marginRight;
+                    int x = offsetX + global::LOGICAL_WIDTH - marginRight;
                     x -= runOnTexture->getWidth();
                     int y = offsetY + (item->getHeight() - runOnTexture->getHeight()) / 2;
                     if (item->getSelectedIndex() == 0)
@@ -765,7 +668,7 @@ Config file is updated with new values when program exit.
                 }
                 else
                 {
-                    int x = offsetX + global::SCREEN_HEIGHT - marginRight;
+                    int x = offsetX + global::LOGICAL_WIDTH - marginRight;
                     int y = offsetY + item->getValueOffsetY();
                     if (index == selectedItemIndex) {
                         x -= nextTexture->getWidth();
@@ -780,51 +683,99 @@ Config file is updated with new values when program exit.
                     }
                 }
             }
-            // update offset and index
-            offsetY += item->getHeight();
-            index++;
         }
     }
 
-    void ScrollLeft() {
-        double step = 1;
-        while (step > 0) {
-            SDL_RenderClear(global::renderer);
+    // switch to group with animation, previous group slides out while
+    // selected group slides in, a running animation is skipped
+    void startGroupScroll(unsigned int groupIndex) {
+        scrollFromGroupIndex = selectedGroupIndex;
+        scrollDirection = groupIndex < selectedGroupIndex ? -1 : 1;
+        scrollStartTicks = SDL_GetTicks();
 
-            // render setting items
-            double easing = easeInOutQuart(step); 
-            int offsetX = static_cast<int>(-global::SCREEN_HEIGHT * easing);
-            renderAllSettings(offsetX, false);
-
-            selectedGroupIndex++;
-            renderAllSettings(offsetX + global::SCREEN_HEIGHT, false, false);
-            selectedGroupIndex--;
-
-            SDL_RenderPresent(global::renderer);
-            SDL_Delay(30);
+        selectedGroupIndex = groupIndex;
+        updateGroupNameTexture();
+        updateItemIndexTexture();
+    }
 
-            step -= 1.0 / 15;
+    // render frame of group switch animation by elapsed time,
+    // keep drawing until the animation ends
+    void renderGroupScroll() {
+        double step = 1 - static_cast<double>(SDL_GetTicks() - scrollStartTicks) / SCROLL_DURATION;
+        if (step <= 0) {
+            scrollDirection = 0;
+            renderAllSettings(selectedGroupIndex);
+            return;
         }
+
+        double easing = easeInOutQuart(step);
+        int offsetX = static_cast<int>(scrollDirection * global::LOGICAL_WIDTH * easing);
+        renderAllSettings(selectedGroupIndex, offsetX, false);
+        renderAllSettings(scrollFromGroupIndex, offsetX - scrollDirection * global::LOGICAL_WIDTH,
+            false, false);
+        isRedrawNeeded = true;
     }
 
-    void ScrollRight() {
-        double step = 1;
-        while (step > 0) {
-            SDL_RenderClear(global::renderer);
+    // read the portrait display before present and write it to png file
+    bool saveScreenshot(const string &filename) {
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(
+            0, global::SCREEN_WIDTH, global::SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (surface == nullptr) return false;
+
+        bool isSaved = SDL_RenderReadPixels(global::renderer, nullptr, SDL_PIXELFORMAT_ARGB8888,
+                surface->pixels, surface->pitch) == 0 &&
+            IMG_SavePNG(surface, filename.c_str()) == 0;
+        SDL_FreeSurface(surface);
+        return isSaved;
+    }
 
-            // render setting items
-            double easing = easeInOutQuart(step); 
-            int offsetX = static_cast<int>(global::SCREEN_HEIGHT * easing);
-            renderAllSettings(offsetX, false);
+    // render frames of each group without input and print their cost as
+    // json lines, first frame includes creating textures of visible items
+    void renderHeadless() {
+        unsigned int firstGroupIndex = isShowSinglePage ? selectedGroupIndex : 0;
+        unsigned int lastGroupIndex = isShowSinglePage ? selectedGroupIndex : settingGroups.size() - 1;
+        for (unsigned int groupIndex = firstGroupIndex; groupIndex <= lastGroupIndex; groupIndex++)
+        {
+            selectedGroupIndex = groupIndex;
+            updateGroupNameTexture();
+            updateItemIndexTexture();
 
-            selectedGroupIndex--;
-            renderAllSettings(offsetX - global::SCREEN_HEIGHT, false, false);
-            selectedGroupIndex++;
+            vector<double> times;
+            for (int i = 0; i < headlessFrameCount; i++) {
+                Uint64 start = SDL_GetPerformanceCounter();
+                {
+                    ProfileScope renderScope(ProfilePhase::render);
+                    beginFrame();
+                    renderAllSettings(selectedGroupIndex);
+                }
+                renderProfileOverlay();
+                presentFrame();
+                global::profiler.endFrame();
+                times.push_back(static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0 /
+                    static_cast<double>(SDL_GetPerformanceFrequency()));
+            }
 
-            SDL_RenderPresent(global::renderer);
-            SDL_Delay(30);
+            double firstTime = times.front();
+            double sum = 0;
+            for (auto t : times) sum += t;
+            std::sort(times.begin(), times.end());
+            cout << std::fixed << std::setprecision(3)
+                << "{\"group\":" << quoted(settingGroups[groupIndex]->getName())
+                << ",\"frames\":" << times.size()
+                << ",\"first_ms\":" << firstTime
+                << ",\"mean_ms\":" << sum / times.size()
+                << ",\"p50_ms\":" << times[times.size() / 2]
+                << ",\"p95_ms\":" << times[times.size() * 95 / 100]
+                << ",\"max_ms\":" << times.back() << '}' << endl;
+        }
 
-            step -= 1.0 / 15;
+        // draw last group once more, untimed, for screenshot
+        if (!screenshotFilename.empty()) {
+            beginFrame();
+            renderAllSettings(selectedGroupIndex);
+            drawScreen();
+            if (!saveScreenshot(screenshotFilename))
+                printErrorAndExit("cannot write file: ", screenshotFilename);
         }
     }
 
@@ -833,6 +784,8 @@ Config file is updated with new values when program exit.
 		if (event.type != SDL_KEYDOWN)
 			return;
 
+        isRedrawNeeded = true;
+
         auto group = settingGroups[selectedGroupIndex];
         unsigned int index = group->getSelectedIndex(); 
 
@@ -867,25 +820,20 @@ Config file is updated with new values when program exit.
 			break;
 		// button Y (Left Alt key)
 		case SDLK_LALT:
+            global::profiler.setOverlayShown(!global::profiler.isOverlayShown());
 			break;
 		// button L1 (Tab key)
 		case SDLK_TAB:
             if (selectedGroupIndex > 0 && !isShowSinglePage)
             { 
-                selectedGroupIndex--;
-                updateGroupNameTexture();
-                updateItemIndexTexture();
-                ScrollLeft();
+                startGroupScroll(selectedGroupIndex - 1);
             }
             break;
 		// button R1 (Backspace key)
 		case SDLK_BACKSPACE:
             if (selectedGroupIndex < settingGroups.size() - 1 && !isShowSinglePage)
             {
-                selectedGroupIndex++;
-                updateGroupNameTexture();
-                updateItemIndexTexture();
-                ScrollRight();
+                startGroupScroll(selectedGroupIndex + 1);
             }
 			break;
         // button START
@@ -915,8 +863,31 @@ Config file is updated with new values when program exit.
 
 int main(int argc, char *argv[])
 {
+    // handle options 
+    handleOptions(argc, argv);
+
+    // on exit apply commands are done already, do not wait for value,
+    // info and update commands still running on workers
+    atexit(killRunningProcesses);
+
+    // generate options without initializing SDL
+    if (isGenerateOptionsOnly) {
+        loadConfigFile(argv[1]);
+        saveOptionsFile();
+        return 0;
+    }
+
 	// Init SDL
-	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
+	long long traceStart = global::tracer.now();
+	// headless mode renders offscreen, dummy driver is used if SDL has no offscreen driver
+	bool isHeadless = headlessFrameCount > 0;
+	if (isHeadless) setenv("SDL_VIDEODRIVER", "offscreen", 0);
+	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) != 0 && isHeadless)
+	{
+		setenv("SDL_VIDEODRIVER", "dummy", 1);
+		if (SDL_Init(SDL_INIT_VIDEO) != 0)
+			printErrorAndExit("SDL_Init failed: ", SDL_GetError());
+	}
 	if (IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF | IMG_INIT_WEBP) == 0)
 	{
 		printErrorAndExit("IMG_Init failed");
@@ -926,61 +897,103 @@ int main(int argc, char *argv[])
 		// Clear the errors for image libraries that did not initialize.
 		SDL_ClearError();
 	}
+	traceSince("SDL init", traceStart);
 
 	// Init font
+	traceStart = global::tracer.now();
 	if (TTF_Init() == -1)
 		printErrorAndExit("TTF_Init failed: ", SDL_GetError());
 
 	global::font = TTF_OpenFont((resourcePath + "./nunwen.ttf").c_str(), fontSize*2);
 	if (global::font == nullptr)
 		printErrorAndExit("Font loading failed: ", TTF_GetError());
+	traceSince("TTF init", traceStart);
 
 	// Hide cursor before creating the output surface.
 	SDL_ShowCursor(SDL_DISABLE);
 
 	// Create window and renderer
+	traceStart = global::tracer.now();
 	SDL_Window *window = SDL_CreateWindow("Main", 0, 0, global::SCREEN_WIDTH, global::SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-	global::renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+	global::renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_TARGETTEXTURE |
+		(isHeadless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_PRESENTVSYNC));
 	if (global::renderer == nullptr)
 		printErrorAndExit("Renderer creation failed");
 
-    // handle options 
-    handleOptions(argc, argv);
+	// glyph cache for texts changing during navigation
+	global::glyphAtlas = new GlyphAtlas(global::font);
+	traceSince("create renderer", traceStart);
 
 	// load config file and create settingItem instances
 	loadConfigFile(argv[1]);
 
+    // print frame timings if they were collected
+    atexit([]() { global::profiler.printSummary(); });
+
     // prepare common textures
     prepareTextures();
     updateGroupNameTexture();
     updateItemIndexTexture();
 
+    // measure rendering without window and input
+    if (isHeadless) {
+        renderHeadless();
+        return 0;
+    }
+
 	// Execute main loop of the window
 	while (true)
 	{
-		// handle input events
+		// wait for input events while the screen is up to date,
+		// or just take pending ones when a redraw or idle work is due
 		SDL_Event event;
-		while (SDL_PollEvent(&event))
+		int hasEvent = isRedrawNeeded || hasIdleWork ?
+			SDL_PollEvent(&event) :
+			SDL_WaitEventTimeout(&event, idleWaitTimeout);
+		// handle events, timed for profiler
 		{
-			switch (event.type)
+			ProfileScope eventsScope(ProfilePhase::events);
+			while (hasEvent)
 			{
-			case SDL_KEYDOWN:
-				keyPress(event);
-				break;
-			case SDL_QUIT:
-				return 0;
-				break;
+				switch (event.type)
+				{
+				case SDL_KEYDOWN:
+					keyPress(event);
+					break;
+				case SDL_WINDOWEVENT:
+					isRedrawNeeded = true;
+					break;
+				case SDL_QUIT:
+					return 0;
+					break;
+				default:
+					if (event.type == SettingItem::getUpdateEventType()) {
+						SettingItem::handleUpdateEvent(event);
+						isRedrawNeeded = true;
+					}
+					break;
+				}
+				hasEvent = SDL_PollEvent(&event);
 			}
 		}
 
-        // render setting items
-        SDL_SetRenderDrawColor(global::renderer, 40, 40, 40, 255);
-        SDL_RenderClear(global::renderer);
-        renderAllSettings();
-        SDL_RenderPresent(global::renderer);
+		if (!isRedrawNeeded) {
+			if (hasIdleWork) hasIdleWork = prepareIdleTextures();
+			continue;
+		}
+		isRedrawNeeded = false;
 
-		// delay for around 30 fps
-		SDL_Delay(30);
+        // render setting items, present is paced by vsync,
+        // group switch animation keeps input responsive between frames
+        {
+            ProfileScope renderScope(ProfilePhase::render);
+            beginFrame();
+            if (scrollDirection != 0) renderGroupScroll();
+            else renderAllSettings(selectedGroupIndex);
+        }
+        renderProfileOverlay();
+        presentFrame();
+        global::profiler.endFrame();
 	}
 
 	SDL_DestroyRenderer(global::renderer);
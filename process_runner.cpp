@@ -0,0 +1,193 @@
+#include "process_runner.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef _POSIX_SPAWN
+#include <spawn.h>
+#endif
+
+#include "tracer.h"
+
+extern char **environ;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // process groups of running commands, killed on exit
+    std::mutex runningMutex;
+    std::set<pid_t> runningProcesses;
+    bool isKillingProcesses = false;
+
+    // add started process, kill it at once if exiting already
+    void addRunningProcess(pid_t pid) {
+        std::lock_guard<std::mutex> lock(runningMutex);
+        if (isKillingProcesses) kill(-pid, SIGKILL);
+        else runningProcesses.insert(pid);
+    }
+
+    void removeRunningProcess(pid_t pid) {
+        std::lock_guard<std::mutex> lock(runningMutex);
+        runningProcesses.erase(pid);
+    }
+
+    // start shell in a new process group with stdout redirected to
+    // outputFd if it is not -1, return pid or -1 if failed
+    pid_t startShell(const string & command, int outputFd, int unusedFd) {
+        char shell[] = "/bin/sh";
+        char option[] = "-c";
+        char *argv[] = { shell, option, const_cast<char*>(command.c_str()), nullptr };
+
+#ifdef _POSIX_SPAWN
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if (outputFd >= 0) {
+            posix_spawn_file_actions_adddup2(&actions, outputFd, STDOUT_FILENO);
+            posix_spawn_file_actions_addclose(&actions, unusedFd);
+        }
+
+        posix_spawnattr_t attributes;
+        posix_spawnattr_init(&attributes);
+        posix_spawnattr_setpgroup(&attributes, 0);
+
+        // commands get default SIGPIPE even if it is ignored by whoever started us
+        sigset_t defaultSignals;
+        sigemptyset(&defaultSignals);
+        sigaddset(&defaultSignals, SIGPIPE);
+        posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+        posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF);
+
+        pid_t pid;
+        int error = posix_spawn(&pid, shell, &actions, &attributes, argv, environ);
+        posix_spawnattr_destroy(&attributes);
+        posix_spawn_file_actions_destroy(&actions);
+        return (error == 0) ? pid : -1;
+#else
+        pid_t pid = fork();
+        if (pid == 0) {
+            setpgid(0, 0);
+            signal(SIGPIPE, SIG_DFL);
+            if (outputFd >= 0) {
+                dup2(outputFd, STDOUT_FILENO);
+                close(unusedFd);
+            }
+            execv(shell, argv);
+            _exit(127);
+        }
+        return pid;
+#endif
+    }
+
+    // milliseconds left until deadline, -1 for no deadline
+    int getRemainingTime(bool hasDeadline, Clock::time_point deadline) {
+        if (!hasDeadline) return -1;
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        return remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
+    }
+
+    // read until end of file or error, return false if deadline passed
+    bool readAll(int fd, string & output, bool hasDeadline, Clock::time_point deadline) {
+        char buffer[4096];
+        while (true) {
+            pollfd pollFd = { fd, POLLIN, 0 };
+            int ready = poll(&pollFd, 1, getRemainingTime(hasDeadline, deadline));
+            if (ready == 0) return false;
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                return true;
+            }
+
+            ssize_t length = read(fd, buffer, sizeof buffer);
+            if (length > 0) {
+                output.append(buffer, static_cast<size_t>(length));
+            } else if (length == 0 || errno != EINTR) {
+                return true;
+            }
+        }
+    }
+
+    // wait for exit, return false if deadline passed
+    bool waitExit(pid_t pid, int & status, bool hasDeadline, Clock::time_point deadline) {
+        while (true) {
+            pid_t waited = waitpid(pid, &status, hasDeadline ? WNOHANG : 0);
+            if (waited == pid) return true;
+            if (waited < 0 && errno != EINTR) {
+                status = -1;
+                return true;
+            }
+            if (waited == 0) {
+                int remaining = getRemainingTime(hasDeadline, deadline);
+                if (remaining == 0) return false;
+
+                // no descriptor to wait on, check again shortly
+                poll(nullptr, 0, remaining < 10 ? remaining : 10);
+            }
+        }
+    }
+
+    int getExitStatus(int status) {
+        if (status == -1) return -1;
+        if (WIFEXITED(status)) return WEXITSTATUS(status);
+        if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+        return -1;
+    }
+}
+
+ProcessResult runProcess(const string & command, bool isOutputCaptured,
+    std::chrono::milliseconds timeout)
+{
+    TraceScope traceScope("exec", "command", command);
+
+    ProcessResult result;
+    auto startTime = Clock::now();
+    bool hasDeadline = timeout.count() > 0;
+    auto deadline = startTime + timeout;
+
+    // close-on-exec, so commands started by other threads do not keep
+    // the pipe open, the child gets its own copy through dup2
+    int outputPipe[2] = { -1, -1 };
+    if (isOutputCaptured && pipe2(outputPipe, O_CLOEXEC) != 0) return result;
+
+    pid_t pid = startShell(command, outputPipe[1], outputPipe[0]);
+    if (pid > 0) addRunningProcess(pid);
+
+    bool isFinished = true;
+    if (isOutputCaptured) {
+        close(outputPipe[1]);
+        if (pid > 0) isFinished = readAll(outputPipe[0], result.output, hasDeadline, deadline);
+        close(outputPipe[0]);
+    }
+
+    if (pid > 0) {
+        int status = -1;
+        if (isFinished) isFinished = waitExit(pid, status, hasDeadline, deadline);
+
+        // watchdog, kill the shell and everything it started
+        if (!isFinished) {
+            kill(-pid, SIGKILL);
+            waitExit(pid, status, false, deadline);
+            result.isTimedOut = true;
+        }
+        result.exitStatus = getExitStatus(status);
+        removeRunningProcess(pid);
+    }
+
+    result.wallTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - startTime);
+    return result;
+}
+
+void killRunningProcesses()
+{
+    std::lock_guard<std::mutex> lock(runningMutex);
+    isKillingProcesses = true;
+    for (pid_t pid : runningProcesses) kill(-pid, SIGKILL);
+}
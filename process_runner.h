@@ -0,0 +1,33 @@
+#ifndef PROCESS_RUNNER_H
+#define PROCESS_RUNNER_H
+
+#include <chrono>
+#include <string>
+
+using std::string;
+
+struct ProcessResult
+{
+    // exit code of the command, 128 + signal number if it was killed,
+    // or -1 if it cannot be started
+    int exitStatus = -1;
+    // stdout of the command if captured
+    string output;
+    // time from start until exit, or until killed after timeout
+    std::chrono::milliseconds wallTime{0};
+    // command was killed after timeout
+    bool isTimedOut = false;
+};
+
+// run command with /bin/sh -c using posix_spawn, so the process is not
+// forked with a copy of our memory, and wait for it to exit,
+// the command runs in its own process group which is killed when a
+// non-zero timeout passes
+ProcessResult runProcess(const string & command, bool isOutputCaptured = false,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+// kill process groups of running commands and of commands started later,
+// so exit does not wait for command workers
+void killRunningProcesses();
+
+#endif // PROCESS_RUNNER_H
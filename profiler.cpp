@@ -0,0 +1,133 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "global.h"
+
+namespace {
+    const char *PHASE_NAMES[] = { "events", "render", "textures", "present", "exec", "frame" };
+
+    struct Stats {
+        double average;
+        double p50;
+        double p95;
+        double p99;
+    };
+
+    Stats getStats(vector<double> values) {
+        Stats stats = { 0, 0, 0, 0 };
+        if (values.empty()) return stats;
+
+        std::sort(values.begin(), values.end());
+        for (double value : values) stats.average += value;
+        stats.average /= static_cast<double>(values.size());
+
+        auto percentile = [&values](size_t p) { return values[(values.size() - 1) * p / 100]; };
+        stats.p50 = percentile(50);
+        stats.p95 = percentile(95);
+        stats.p99 = percentile(99);
+        return stats;
+    }
+}
+
+Profiler::Profiler()
+    : isEnabled_(false)
+{
+    for (auto &counter : current_) counter.store(0, std::memory_order_relaxed);
+}
+
+Profiler::~Profiler()
+{
+    if (csvFile_ != nullptr) fclose(csvFile_);
+}
+
+void Profiler::updateEnabled()
+{
+    isEnabled_.store(isOverlayShown_ || csvFile_ != nullptr, std::memory_order_relaxed);
+}
+
+void Profiler::setOverlayShown(bool isShown)
+{
+    isOverlayShown_ = isShown;
+    updateEnabled();
+}
+
+bool Profiler::openCsvFile(const string & filename)
+{
+    if (csvFile_ != nullptr) fclose(csvFile_);
+    csvFile_ = fopen(filename.c_str(), "w");
+    updateEnabled();
+    if (csvFile_ == nullptr) return false;
+
+    fputs("frame", csvFile_);
+    for (auto name : PHASE_NAMES) fprintf(csvFile_, ",%s_ms", name);
+    fputc('\n', csvFile_);
+    return true;
+}
+
+void Profiler::add(ProfilePhase phase, Uint64 counter)
+{
+    current_[static_cast<size_t>(phase)].fetch_add(counter, std::memory_order_relaxed);
+}
+
+void Profiler::endFrame()
+{
+    if (!isEnabled()) return;
+
+    // take timings since last frame, whole frame is the time of main loop
+    double times[COLUMN_COUNT];
+    double frequency = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0;
+    for (size_t i = 0; i < PHASE_COUNT; i++) {
+        times[i] = static_cast<double>(current_[i].exchange(0, std::memory_order_relaxed)) / frequency;
+    }
+    times[PHASE_COUNT] = times[static_cast<size_t>(ProfilePhase::events)] +
+        times[static_cast<size_t>(ProfilePhase::render)] +
+        times[static_cast<size_t>(ProfilePhase::present)];
+
+    for (size_t i = 0; i < COLUMN_COUNT; i++) {
+        if (history_[i].size() < HISTORY_SIZE) history_[i].push_back(times[i]);
+        else history_[i][historyPos_] = times[i];
+    }
+    historyPos_ = (historyPos_ + 1) % HISTORY_SIZE;
+    frameCount_++;
+
+    if (csvFile_ != nullptr) {
+        fprintf(csvFile_, "%zu", frameCount_);
+        for (double time : times) fprintf(csvFile_, ",%.3f", time);
+        fputc('\n', csvFile_);
+    }
+}
+
+vector<string> Profiler::getSummaryLines() const
+{
+    vector<string> lines;
+    char line[128];
+    snprintf(line, sizeof line, "%-8s %6s %6s %6s %6s  (%zu frames)", "ms", "avg", "p50", "p95", "p99", frameCount_);
+    lines.push_back(line);
+
+    for (size_t i = 0; i < COLUMN_COUNT; i++) {
+        Stats stats = getStats(history_[i]);
+        snprintf(line, sizeof line, "%-8s %6.2f %6.2f %6.2f %6.2f",
+            PHASE_NAMES[i], stats.average, stats.p50, stats.p95, stats.p99);
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+void Profiler::printSummary() const
+{
+    if (frameCount_ == 0) return;
+    for (const auto &line : getSummaryLines()) std::cerr << line << std::endl;
+}
+
+ProfileScope::ProfileScope(ProfilePhase phase)
+    : phase_(phase)
+{
+    if (global::profiler.isEnabled()) start_ = SDL_GetPerformanceCounter();
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (start_ != 0) global::profiler.add(phase_, SDL_GetPerformanceCounter() - start_);
+}
@@ -0,0 +1,84 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+
+using std::string;
+using std::vector;
+
+// measured parts of a frame, textures are created while rendering or
+// when idle, exec runs on command workers
+enum class ProfilePhase : unsigned char { events, render, textures, present, exec, count };
+
+// frame timings collected only while overlay is shown or a CSV file is written
+class Profiler
+{
+public:
+    Profiler();
+    ~Profiler();
+
+    // disallow copying and assignment
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    bool isEnabled() const { return isEnabled_.load(std::memory_order_relaxed); }
+
+    bool isOverlayShown() const { return isOverlayShown_; }
+    void setOverlayShown(bool isShown);
+
+    // write timings of every frame to CSV file, return false if file cannot open
+    bool openCsvFile(const string & filename);
+
+    // add time of phase to current frame, can be called from any thread
+    void add(ProfilePhase phase, Uint64 counter);
+
+    // store timings of current frame and start next one
+    void endFrame();
+
+    // text lines with rolling average and percentiles in milliseconds
+    vector<string> getSummaryLines() const;
+
+    // print summary of recorded frames to stderr
+    void printSummary() const;
+
+private:
+    static const size_t PHASE_COUNT = static_cast<size_t>(ProfilePhase::count);
+    // one more column for whole frame
+    static const size_t COLUMN_COUNT = PHASE_COUNT + 1;
+    static const size_t HISTORY_SIZE = 120;
+
+    void updateEnabled();
+
+    std::atomic<bool> isEnabled_;
+    bool isOverlayShown_ = false;
+    FILE *csvFile_ = nullptr;
+    std::atomic<Uint64> current_[PHASE_COUNT];
+
+    // frame timings in milliseconds, ring buffer for each column
+    vector<double> history_[COLUMN_COUNT];
+    size_t historyPos_ = 0;
+    size_t frameCount_ = 0;
+};
+
+// add time until end of scope to phase if profiler is enabled
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfilePhase phase);
+    ~ProfileScope();
+
+    // disallow copying and assignment
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const ProfilePhase phase_;
+    Uint64 start_ = 0;
+};
+
+#endif // PROFILER_H
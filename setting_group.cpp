@@ -0,0 +1,32 @@
+#include "setting_group.h"
+
+#include <algorithm>
+
+bool SettingGroup::updateLayout(unsigned int index)
+{
+    if (items_.empty()) return false;
+    if (index >= items_.size()) index = items_.size() - 1;
+
+    // heights of items before first changed item are kept
+    bool isCreated = false;
+    itemTops_.resize(measuredCount_ + 1);
+    while (measuredCount_ <= index) {
+        auto item = items_[measuredCount_];
+        if (item->createTextures()) isCreated = true;
+        itemTops_.push_back(itemTops_.back() + item->getHeight());
+        measuredCount_++;
+    }
+    return isCreated;
+}
+
+unsigned int SettingGroup::findTopIndex(unsigned int topIndex, unsigned int index, int height) const
+{
+    if (topIndex > index) return index;
+    if (getItemBottom(index) - getItemTop(topIndex) <= height) return topIndex;
+
+    // first item starting at or below the top of visible range ending with item
+    auto first = itemTops_.begin() + topIndex;
+    auto last = itemTops_.begin() + index;
+    auto it = std::lower_bound(first, last, getItemBottom(index) - height);
+    return static_cast<unsigned int>(it - itemTops_.begin());
+}
@@ -18,6 +18,11 @@ public:
     const string & getName() const { return name_; }
     const string & getOutputFilename() const { return outputFilename_; }
     vector<SettingItem*> & getItems() { return items_; }
+    // add item to end of group, item reports height changes to group
+    void addItem(SettingItem *item) {
+        item->setGroup(this, items_.size());
+        items_.push_back(item);
+    }
     unsigned int getSize() const { return items_.size(); }
     SettingItem * getSelectedItem() const { 
         if (items_.size() == 0) throw std::logic_error("no item");
@@ -40,12 +45,30 @@ public:
         if (items_.size() == 0) throw std::logic_error("no item");
         if (index >= items_.size()) throw std::out_of_range("invalid item index");
         displayTopIndex_ = index;
-    }    
+    }
+
+    // create textures of items up to index and measure their heights,
+    // return true if any textures are created
+    bool updateLayout(unsigned int index);
+    // distance from top of first item to top of item, valid after updateLayout(index)
+    int getItemTop(unsigned int index) const { return itemTops_[index]; }
+    int getItemBottom(unsigned int index) const { return itemTops_[index + 1]; }
+    // smallest top index, not less than topIndex, showing items from it
+    // to index within height, valid after updateLayout(index)
+    unsigned int findTopIndex(unsigned int topIndex, unsigned int index, int height) const;
+    // height of item is changed, measure it and the items after it again
+    void invalidateLayout(unsigned int index) {
+        if (index < measuredCount_) measuredCount_ = index;
+    }
 private:
     const string name_, outputFilename_;
     vector<SettingItem*> items_;
     unsigned int selectedIndex_ = 0;
     unsigned int displayTopIndex_ = 0;
+
+    // itemTops_[i] is sum of heights of first i items, for measured items
+    vector<int> itemTops_ = { 0 };
+    unsigned int measuredCount_ = 0;
 };
 
 #endif // SETTING_GROUP_H
\ No newline at end of file
@@ -3,26 +3,16 @@
 #include <cstdlib>
 #include <string>
 #include <algorithm>
+#include <iostream>
 
 #include "global.h"
+#include "process_runner.h"
+#include "config_parser.h"
+#include "setting_group.h"
 
-namespace {
-    // split string with delimiter into vector of tokens
-    vector<string> split(const string& s, const string& delimiter) {
-        string copy_s = s;
-        vector<string> tokens;
-        size_t pos = 0;
-        string token;
-        while ((pos = copy_s.find(delimiter)) != string::npos) {
-            token = copy_s.substr(0, pos);
-            tokens.push_back(token);
-            copy_s.erase(0, pos + delimiter.length());
-        }
-        tokens.push_back(copy_s);
-
-        return tokens;
-    }
+using std::cerr;
 
+namespace {
     // search string in string vector and return zero-based index if found
     // return -1 if no element is find
     int find(vector<string> v, string s)
@@ -35,43 +25,37 @@ namespace {
             return -1;
     }
 
+    // commands are killed after this time unless item sets its own timeout
+    const std::chrono::milliseconds DEFAULT_COMMAND_TIMEOUT(10000);
+
+    // shown instead of output of a command which is killed
+    const string TIMEOUT_TEXT = "(command timed out)";
+
     // run command and get output from stdout 
     // return empty string if error occurs
-    string exec(const string & cmd) {
-        char buffer[1024];
-        std::string result = "";
-        FILE* pipe = popen(cmd.c_str(), "r");
-        if (!pipe) return "";
-        try {
-            while (fgets(buffer, sizeof buffer, pipe) != NULL) {
-                result += buffer;
-            }
-        } catch (...) {
-
+    string exec(const string & cmd, std::chrono::milliseconds timeout, bool & isTimedOut) {
+        ProfileScope profileScope(ProfilePhase::exec);
+        auto result = runProcess(cmd, true, timeout);
+        isTimedOut = result.isTimedOut;
+        if (isTimedOut) {
+            cerr << global::programName + ": command timed out after " +
+                std::to_string(result.wallTime.count()) + " ms: " + cmd + "\n";
         }
-        pclose(pipe);
-        return result;
+        return result.output;
     }
 }
 
 SettingItem::SettingItem(const string & infoCommand)
-    : description_(exec(global::replaceAliases(infoCommand))),
-    commandsString_(infoCommand),
-    isInfoText_(true)
+    : commandsString_(infoCommand),
+    isInfoText_(true), timeout_(DEFAULT_COMMAND_TIMEOUT)
 {
-    if (description_.empty()) {
-        isInitOK_ = false;
-        return;
-    }
-
-    // create texture for description text
-    descriptionTexture_ = new TextTexture(
-        description_, 
-        global::font,
-        global::minor_text_color
-    );
-    
-    isInitOK_ = true;
+    // run info command in background, result is collected in finishInit()
+    string cmd = global::replaceAliases(infoCommand);
+    pendingInit_ = global::commandPool.submit([cmd]() {
+        InitResult result;
+        result.value = exec(cmd, DEFAULT_COMMAND_TIMEOUT, result.isValueTimedOut);
+        return result;
+    });
 }
 
 SettingItem::SettingItem(
@@ -81,11 +65,13 @@ SettingItem::SettingItem(
         const string & displayValuesString,
         const string & selectedValue,
         const string & commandsString,
-        const string & infoCommandString
+        const string & infoCommandString,
+        const string & flagsString
         )
     :id_(id), description_(description), optionsString_(optionsString),
      displayValuesString_(displayValuesString), selectedValue_(selectedValue),
-     commandsString_(commandsString), infoCommandString_(infoCommandString)
+     commandsString_(commandsString), infoCommandString_(infoCommandString),
+     flagsString_(flagsString), timeout_(DEFAULT_COMMAND_TIMEOUT)
 {
     options_ = split(optionsString_, "|");
     displayValues_ = split(displayValuesString_, "|");
@@ -98,90 +84,297 @@ SettingItem::SettingItem(
         return;
     } 
 
+    // parse optional flags
+    if (!flagsString_.empty()) {
+        for (const auto & flag : split(flagsString_, "|")) {
+            if (flag == "nocache") {
+                isUpdateCacheEnabled_ = false;
+            } else if (flag.compare(0, 6, "order=") == 0 && flag.length() > 6) {
+                orderKey_ = flag.substr(6);
+            } else if (flag.compare(0, 8, "timeout=") == 0 && flag.length() > 8 &&
+                flag.length() <= 13 && flag.find_first_not_of("0123456789", 8) == string::npos) {
+                // up to 99999 seconds, 0 means no timeout
+                timeout_ = std::chrono::seconds(std::stoul(flag.substr(8)));
+            } else {
+                // unknown flags are ignored so configs of other versions still load
+                cerr << global::programName + ": ignoring unknown flag " + flag + " of " + id_ + "\n";
+            }
+        }
+    }
+
     // try to find index of the selected value 
     int index = find(displayValues_, selectedValue_);
     // if selected value not found in displayValues, assume it is command for source value 
     if (index < 0) {
-        // try run command and get result as selected value
         sourceCommandString_ = selectedValue_;
-        string cmd = global::replaceAliases(sourceCommandString_);
-        selectedValue_ = exec(cmd);
-        index = find(displayValues_, selectedValue_);
+    } else {
+        oldSelectedIndex_ = selectedIndex_ = static_cast<unsigned int>(index);
+    }
+
+    // nothing to run, textures are created in finishInit()
+    if (sourceCommandString_.empty() && infoCommandString_.empty()) return;
+
+    // expand user aliases here, workers only fill in _INDEX_ and _VALUE_
+    string sourceCommand;
+    if (!sourceCommandString_.empty())
+        sourceCommand = global::replaceAliases(sourceCommandString_);
+    CommandTemplate infoCommand;
+    if (!infoCommandString_.empty())
+        infoCommand = CommandTemplate(infoCommandString_);
+
+    // run source value and info commands in background
+    pendingInit_ = global::commandPool.submit(
+        [sourceCommand, infoCommand, timeout = timeout_, value = selectedValue_,
+            displayValues = displayValues_]() {
+            InitResult result;
+            result.value = value;
+            if (!sourceCommand.empty())
+                result.value = exec(sourceCommand, timeout, result.isValueTimedOut);
+
+            int i = find(displayValues, result.value);
+            if (!infoCommand.empty() && i >= 0) {
+                infoCommand.expand(result.updateCommand, static_cast<unsigned int>(i), result.value);
+                result.minorText = exec(result.updateCommand, timeout, result.isMinorTextTimedOut);
+            }
+            return result;
+        });
+}
+
+void SettingItem::finishInit()
+{
+    if (isInitFinished_) return;
+    isInitFinished_ = true;
+
+    // item is invalid already
+    if (!errorMessage_.empty()) return;
+
+    // get result of background commands
+    InitResult result;
+    if (pendingInit_.valid()) result = pendingInit_.get();
+
+    if (isInfoText_) {
+        description_ = result.isValueTimedOut ? TIMEOUT_TEXT : result.value;
+        if (description_.empty()) return;
+
+        isInitOK_ = true;
+        return;
+    }
+
+    // value is unknown if command was killed, first value is only shown
+    // as placeholder and cannot be changed
+    if (result.isValueTimedOut) {
+        isValueUnknown_ = true;
+        selectedValue_ = displayValues_[0];
+        oldSelectedIndex_ = selectedIndex_ = 0;
+        result.minorText = TIMEOUT_TEXT;
+        result.isMinorTextTimedOut = true;
+
+    // use command result as selected value
+    } else if (!sourceCommandString_.empty()) {
+        selectedValue_ = result.value;
+        int index = find(displayValues_, selectedValue_);
 
         if (selectedValue_.empty() || index < 0) {
             errorMessage_ = "invalid option value";
             return;
         }
+
+        // store selected inde to private fields
+        oldSelectedIndex_ = selectedIndex_ = static_cast<unsigned int>(index);
     }
 
-    // store selected inde to private fields
-    oldSelectedIndex_ = selectedIndex_ = static_cast<unsigned int>(index);
+    // all aliases are known now, compile commands run later
+    if (!infoCommandString_.empty()) infoCommandTemplate_ = CommandTemplate(infoCommandString_);
+    for (const auto &command : commands_) commandTemplates_.emplace_back(command);
+
+    // minor text given in config file overrides info command output
+    if (minorText_.empty()) minorText_ = result.minorText;
+    if (!result.updateCommand.empty() && isUpdateCacheEnabled_ && !result.isMinorTextTimedOut) {
+        minorTextCache_[result.updateCommand].text = result.minorText;
+    }
+
+    isInitOK_ = true;
+}
+
+bool SettingItem::createTextures()
+{
+    if (hasTextures_) return false;
+    hasTextures_ = true;
 
     // create texture for description text
     descriptionTexture_ = new TextTexture(
         description_, 
         global::font,
-        global::text_color
+        isInfoText_ ? global::minor_text_color : global::text_color
     );
 
     // create other textures
-    updateTextures();
+    if (!isInfoText_) {
+        valueTextures_.resize(displayValues_.size());
+        updateValueTexture();
+    }
+    updateMinorTextTexture();
 
-    isInitOK_ = true;
+    return true;
 }
 
 void SettingItem::setMinorText(const string & text) {
     minorText_ = text;
+    updateMinorTextTexture();
+}
 
-    if (minorTextTexture_ != nullptr) {
-        delete minorTextTexture_;
-        minorTextTexture_ = nullptr;
+void SettingItem::updateTextures() {
+    if (isInfoText_) return;
+
+    updateValueTexture();
+
+    if (infoCommandString_.empty()) return;
+
+    string & cmd = updateCommandBuffer_;
+    infoCommandTemplate_.expand(cmd, selectedIndex_, selectedValue_);
+
+    // reuse output of the same command if seen before
+    if (isUpdateCacheEnabled_) {
+        auto it = minorTextCache_.find(cmd);
+        if (it != minorTextCache_.end()) {
+            wantedUpdateCommand_.clear();
+            showCachedMinorText(it->second);
+            return;
+        }
     }
 
-    if (!minorText_.empty()) {
-        minorTextTexture_ = new TextTexture(
-            minorText_, 
+    // run command in background to get minor info message,
+    // while a command is running only the latest value is run afterwards
+    wantedUpdateCommand_ = cmd;
+    if (!isUpdateRunning_) startUpdateCommand(cmd);
+}
+
+Uint32 SettingItem::getUpdateEventType() {
+    static const Uint32 eventType = SDL_RegisterEvents(1);
+    return eventType;
+}
+
+void SettingItem::handleUpdateEvent(const SDL_Event &event) {
+    auto item = static_cast<SettingItem*>(event.user.data1);
+    auto result = static_cast<UpdateResult*>(event.user.data2);
+    item->finishUpdateCommand(*result);
+    delete result;
+}
+
+void SettingItem::startUpdateCommand(const string & command) {
+    isUpdateRunning_ = true;
+
+    global::commandPool.post([this, command, timeout = timeout_]() {
+        auto result = new UpdateResult { command, "", false };
+        result->minorText = exec(command, timeout, result->isTimedOut);
+
+        // post result to main thread
+        SDL_Event event;
+        SDL_memset(&event, 0, sizeof(event));
+        event.type = getUpdateEventType();
+        event.user.data1 = this;
+        event.user.data2 = result;
+        // result is lost if event queue is full, allow next value to run its command
+        if (SDL_PushEvent(&event) <= 0) {
+            delete result;
+            isUpdateRunning_ = false;
+        }
+    });
+}
+
+void SettingItem::finishUpdateCommand(const UpdateResult &result) {
+    isUpdateRunning_ = false;
+
+    // output is still valid for its command even if value changed meanwhile,
+    // command killed after timeout is run again next time
+    MinorTextCacheEntry * entry = nullptr;
+    if (isUpdateCacheEnabled_ && !result.isTimedOut) {
+        entry = &minorTextCache_[result.command];
+        entry->text = result.minorText;
+    }
+
+    // value changed again while command was running, run it for the latest value
+    if (result.command != wantedUpdateCommand_) {
+        if (!wantedUpdateCommand_.empty()) startUpdateCommand(wantedUpdateCommand_);
+        return;
+    }
+    wantedUpdateCommand_.clear();
+
+    if (entry != nullptr) {
+        showCachedMinorText(*entry);
+    } else {
+        minorText_ = result.isTimedOut ? TIMEOUT_TEXT : result.minorText;
+        updateMinorTextTexture();
+    }
+}
+
+void SettingItem::showCachedMinorText(MinorTextCacheEntry & entry) {
+    minorText_ = entry.text;
+    if (!hasTextures_) return;
+
+    // texture is created on first display
+    if (entry.texture == nullptr && !entry.text.empty()) {
+        entry.texture = std::make_shared<TextTexture>(
+            entry.text, 
             global::font,
             global::minor_text_color,
             TextureAlignment::topLeft,
-            (global::SCREEN_HEIGHT - 120) * 2
+            (global::LOGICAL_WIDTH - 120) * 2
         );
     }
+    minorTextTexture_ = entry.texture;
+    invalidateLayout();
 }
 
-void SettingItem::updateTextures() {
-    if (isInfoText_) return;
+void SettingItem::invalidateLayout() {
+    if (group_ != nullptr) group_->invalidateLayout(groupIndex_);
+}
 
-    // delete old value texture    
-    if (valueTexture_ != nullptr) delete valueTexture_;
+void SettingItem::updateValueTexture() {
+    if (!hasTextures_) return;
 
-    // create new texture
-    valueTexture_ = new TextTexture(
-        displayValues_[selectedIndex_], 
-        global::font,
-        global::text_color
-    );
+    // lay out value text on first use, then reuse it
+    auto & texture = valueTextures_[selectedIndex_];
+    if (texture == nullptr) {
+        texture = std::make_unique<GlyphText>(
+            displayValues_[selectedIndex_], 
+            global::glyphAtlas,
+            global::text_color
+        );
+    }
+    valueTexture_ = texture.get();
+}
 
-    // try run command to get minor info message
-    if (!infoCommandString_.empty()) {
-        // delete old texture
-        if (minorTextTexture_ != nullptr) {
-            delete minorTextTexture_;
-            minorTextTexture_ = nullptr;
-        }
+bool SettingItem::prepareNextValueTexture() {
+    if (!hasTextures_ || isInfoText_) return false;
 
-        // get new info text and create texture
-        string cmd = global::replaceAliases(infoCommandString_, selectedIndex_, selectedValue_);
-        minorText_ = exec(cmd);
-        if (!minorText_.empty()) {
-            minorTextTexture_ = new TextTexture(
-                minorText_, 
-                global::font,
-                global::minor_text_color,
-                TextureAlignment::topLeft,
-                (global::SCREEN_HEIGHT - 120) * 2
-            );
-        }
+    for (size_t i = 0; i < valueTextures_.size(); i++) {
+        if (valueTextures_[i] != nullptr) continue;
+        valueTextures_[i] = std::make_unique<GlyphText>(
+            displayValues_[i], 
+            global::glyphAtlas,
+            global::text_color
+        );
+        return true;
+    }
+    return false;
+}
+
+void SettingItem::updateMinorTextTexture() {
+    if (!hasTextures_) return;
+
+    // release old texture, it may still be kept in cache
+    minorTextTexture_.reset();
+    invalidateLayout();
+
+    if (!minorText_.empty()) {
+        minorTextTexture_ = std::make_shared<TextTexture>(
+            minorText_, 
+            global::font,
+            global::minor_text_color,
+            TextureAlignment::topLeft,
+            (global::LOGICAL_WIDTH - 120) * 2
+        );
     }
 }
 
@@ -209,7 +402,7 @@ void SettingItem::renderValue(int x, int y) const
 
 void SettingItem::selectPreviousValue()
 {
-    if (isInfoText_) return;
+    if (isInfoText_ || isValueUnknown_) return;
 
     if (selectedIndex_ == 0) selectedIndex_ = options_.size();
     selectedIndex_--;
@@ -221,7 +414,7 @@ void SettingItem::selectPreviousValue()
 
 void SettingItem::selectNextValue()
 {
-    if (isInfoText_) return;
+    if (isInfoText_ || isValueUnknown_) return;
 
     selectedIndex_++;
     if (selectedIndex_ >= options_.size()) selectedIndex_ = 0;
@@ -3,11 +3,23 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <chrono>
+
+#include <SDL.h>
 
 #include "text_texture.h"
+#include "glyph_text.h"
+#include "command_template.h"
 
 using std::string;
 using std::vector;
+using std::map;
+
+class SettingGroup;
 
 class SettingItem
 {
@@ -21,14 +33,30 @@ public:
         const string & displayValuesString,
         const string & selectedValue,
         const string & commandsString,
-        const string & infoCommandString
+        const string & infoCommandString,
+        const string & flagsString = ""
         );
 
+    // wait for background value and info commands
+    void finishInit();
+
+    // create textures when item is first displayed,
+    // return false if they are created already
+    bool createTextures();
+
+    // cache one more value text, return false if all values are cached
+    bool prepareNextValueTexture();
+
+    // SDL user event carrying UPDATE_COMMAND output back to main thread
+    static Uint32 getUpdateEventType();
+    static void handleUpdateEvent(const SDL_Event &event);
     void renderDescription(int offsetX, int offsetY) const;
     void renderValue(int offsetX, int offsetY) const;
     void selectPreviousValue();
     void selectNextValue();
     bool isOnOffSetting() const;
+    // group containing item, told when height of item changes
+    void setGroup(SettingGroup *group, unsigned int index) { group_ = group; groupIndex_ = index; }
     bool isRunOffSetting() const;
 
     const string & getID() const { return id_; }
@@ -40,18 +68,27 @@ public:
     const vector<string> & getOptions() const { return options_; }
     const vector<string> & getDisplayValues() const { return displayValues_; }
     const vector<string> & getCommands() const { return commands_; }
+    const vector<CommandTemplate> & getCommandTemplates() const { return commandTemplates_; }
     const string & getSourceCommandString() const { return sourceCommandString_; }
     const string & getInfoCommandString() const { return infoCommandString_; }
+    const string & getFlagsString() const { return flagsString_; }
+    const string & getOrderKey() const { return orderKey_; }
     const string & getMinorText() const { return minorText_; }
     void setMinorText(const string & text);
+    // raw CURRENT_VALUE field in config file and its offset
+    void setValueSpan(size_t offset, const string & text) { valueSpanOffset_ = offset; valueSpanText_ = text; }
+    size_t getValueSpanOffset() const { return valueSpanOffset_; }
+    const string & getValueSpanText() const { return valueSpanText_; }
     unsigned int getSelectedIndex() const { return selectedIndex_; }
     unsigned int getOldSelectedIndex() const { return oldSelectedIndex_; }
     bool IsInitOK() const { return isInitOK_; }
     bool isInfoText() const { return isInfoText_; }
+    // CURRENT_VALUE command timed out, selected value is a placeholder
+    bool isValueUnknown() const { return isValueUnknown_; }
     const string & getErrorMessage() const { return errorMessage_; }
     TextTexture* getDescriptionTexture() const { return descriptionTexture_; }
-    TextTexture* getValueTexture() const { return valueTexture_; }
-    TextTexture* getMinorTextTexture() const { return minorTextTexture_; }
+    GlyphText* getValueTexture() const { return valueTexture_; }
+    TextTexture* getMinorTextTexture() const { return minorTextTexture_.get(); }
     int getHeight() const {
         if (minorTextTexture_ != nullptr) {
             return descriptionTexture_->getHeight() + minorTextTexture_->getHeight();
@@ -68,7 +105,7 @@ public:
     }
 private:
     const string id_;
-    const string description_;
+    string description_;
     const string optionsString_;
     const string displayValuesString_;
     string selectedValue_;
@@ -76,18 +113,66 @@ private:
     vector<string> options_;
     vector<string> displayValues_;
     vector<string> commands_;
+    vector<CommandTemplate> commandTemplates_;
     unsigned int selectedIndex_, oldSelectedIndex_;
     bool isInitOK_ = false;
+    bool isInitFinished_ = false;
+    bool hasTextures_ = false;
     bool isInfoText_ = false;
+    bool isValueUnknown_ = false;
     string sourceCommandString_;
     string infoCommandString_;
+    CommandTemplate infoCommandTemplate_;
+    string updateCommandBuffer_;
+    const string flagsString_;
+    bool isUpdateCacheEnabled_ = true;
+    string orderKey_;
+    std::chrono::milliseconds timeout_;
     string minorText_;
     string errorMessage_;
+    size_t valueSpanOffset_ = 0;
+    string valueSpanText_;
     TextTexture* descriptionTexture_ = nullptr;
-    TextTexture* valueTexture_ = nullptr;
-    TextTexture* minorTextTexture_ = nullptr;
+    GlyphText* valueTexture_ = nullptr;
+    vector<std::unique_ptr<GlyphText>> valueTextures_;
+    std::shared_ptr<TextTexture> minorTextTexture_;
+    SettingGroup *group_ = nullptr;
+    unsigned int groupIndex_ = 0;
+
+    struct InitResult {
+        string value;
+        string minorText;
+        string updateCommand;
+        bool isValueTimedOut = false;
+        bool isMinorTextTimedOut = false;
+    };
+    std::future<InitResult> pendingInit_;
+
+    // expanded UPDATE_COMMAND whose output is waited for, output of
+    // any other command is stale and dropped
+    string wantedUpdateCommand_;
+    std::atomic<bool> isUpdateRunning_{false};
+
+    struct UpdateResult {
+        string command;
+        string minorText;
+        bool isTimedOut;
+    };
+    void startUpdateCommand(const string & command);
+    void finishUpdateCommand(const UpdateResult &result);
+
+    // UPDATE_COMMAND output and texture keyed by expanded command
+    struct MinorTextCacheEntry {
+        string text;
+        std::shared_ptr<TextTexture> texture;
+    };
+    map<string, MinorTextCacheEntry> minorTextCache_;
+    void showCachedMinorText(MinorTextCacheEntry & entry);
 
     void updateTextures();
+    void updateValueTexture();
+    void updateMinorTextTexture();
+    void invalidateLayout();
 };
 
 #endif // SETTING_ITEM_H
@@ -0,0 +1,372 @@
+#include "settings_file.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "global.h"
+#include "fileutils.h"
+#include "config_parser.h"
+#include "config_cache.h"
+#include "tracer.h"
+
+using std::cout, std::cerr, std::endl;
+using std::ostream;
+using std::ostringstream;
+using std::quoted;
+
+namespace {
+    class BracketedString {
+    public:
+        BracketedString(const string &s) : str(s) {};
+
+        friend ostream & operator<<(ostream &os, BracketedString bs) {
+            os << '[';
+            for(const char& ch : bs.str) { 
+                if (ch == ']') os << '\\'; 
+                os << ch; 
+            } 
+            os << ']';
+            return os;
+        }
+
+    private:
+        const string &str;
+    };
+
+    BracketedString bracketed(const string & s) {
+        return BracketedString(s);
+    }
+
+    // check if any setting value differs from the value loaded
+    bool isAnySettingChanged(const vector<SettingGroup*> & settingGroups) {
+        for (auto &group : settingGroups)
+        {
+            for (auto &item : group->getItems())
+            {
+                if (item->isInfoText()) continue;
+                if (item->getSelectedIndex() != item->getOldSelectedIndex()) return true;
+            }
+        }
+        return false;
+    }
+
+    // write changed values into text of config file, keeping everything else,
+    // return false if a value is not found where it was loaded from
+    bool patchConfigText(const string &filename, const vector<SettingGroup*> & settingGroups,
+        string &text) {
+        ConfigFile file(filename);
+        if (!file.isOpen()) return false;
+        string_view data = file.getData();
+
+        // find changed values, commands for source values are kept
+        vector<SettingItem*> changedItems;
+        for (auto &group : settingGroups)
+        {
+            for (auto &item : group->getItems())
+            {
+                if (item->isInfoText() || !item->getSourceCommandString().empty()) continue;
+                if (item->getSelectedIndex() == item->getOldSelectedIndex()) continue;
+
+                // file may be shortened since loading
+                const auto &span = item->getValueSpanText();
+                auto offset = item->getValueSpanOffset();
+                if (span.empty() || offset > data.size() || span.length() > data.size() - offset ||
+                    data.compare(offset, span.length(), span) != 0)
+                    return false;
+                changedItems.push_back(item);
+            }
+        }
+        std::sort(changedItems.begin(), changedItems.end(), [](SettingItem *a, SettingItem *b) {
+            return a->getValueSpanOffset() < b->getValueSpanOffset();
+        });
+
+        // copy text between changed values
+        ostringstream patched;
+        size_t pos = 0;
+        for (auto &item : changedItems)
+        {
+            patched << data.substr(pos, item->getValueSpanOffset() - pos)
+                << quoted(item->getSelectedValue());
+            pos = item->getValueSpanOffset() + item->getValueSpanText().length();
+        }
+        patched << data.substr(pos);
+
+        text = patched.str();
+        return true;
+    }
+
+    // find option of id in existing options file, return false if not found
+    bool findSavedOption(const string &filename, const string &id, string &option) {
+        if (id.empty()) return false;
+
+        std::ifstream file(filename);
+        string token;
+        while (file >> token) {
+            if (token == id) return static_cast<bool>(file >> option);
+        }
+        return false;
+    }
+
+    // write whole config file from loaded settings
+    string generateConfigText(const vector<SettingGroup*> & settingGroups) {
+		ostringstream file;
+
+        // write all alias to file
+        for (const auto& [key, value] : global::aliases)
+        {
+            string key_ = key;
+            key_ = key.substr(1, key.length() - 2);
+
+            file << quoted(key_ + '=' + value, '$') << endl;
+        }
+
+        // write all settings to file
+        for (auto &group : settingGroups)
+        {
+            file << bracketed(group->getName());
+            if (!group->getOutputFilename().empty())
+               file << ' ' << bracketed(group->getOutputFilename());
+            file << endl;
+            for (auto &item : group->getItems())
+            {
+                // handle info text
+                if (item->isInfoText()) {
+                    file << '%' << quoted(item->getCommandsString()) << endl;
+
+                // handle normal setting item
+                } else {
+                    file << quoted(item->getID()) << ' '
+                        << quoted(item->getDescription()) << ' '
+                        << quoted(item->getOptionsString()) << ' '
+                        << quoted(item->getDisplayValuesString_()) << ' ';
+                        
+                    if (!item->getSourceCommandString().empty())
+                        file << quoted(item->getSourceCommandString());
+                    else
+                        file << quoted(item->getSelectedValue());
+
+                    // if (!item->getCommandsString().empty())
+                        file << ' ' << quoted(item->getCommandsString());
+
+                    // if (!item->getInfoCommandString().empty())
+                        file << ' ' << quoted(item->getInfoCommandString());
+
+                    if (!item->getFlagsString().empty())
+                        file << ' ' << quoted(item->getFlagsString());
+
+                    file << endl;
+
+                    if (!item->getMinorText().empty())
+                        file << '@' << quoted(item->getMinorText()) << endl;
+                }
+            }
+        }
+
+        return file.str();
+    }
+}
+
+vector<SettingGroup*> loadSettingsFile(const string & filename, bool isUseCache)
+{
+    TraceScope traceScope("loadConfigFile", "config", filename);
+
+    // set enivornment variable
+    setenv("IS_LOADING", "true", 1);
+
+    // items before first group line belong to default group
+    vector<SettingGroup*> settingGroups = { new SettingGroup("Default") };
+
+    // items run their commands in background while parsing continues,
+    // wait for them in config order so the first failing line is reported
+    vector<std::pair<SettingItem*, string>> loadingItems;
+    auto finishLoadingItems = [&loadingItems]() {
+        for (auto &[item, itemLine] : loadingItems) {
+            item->finishInit();
+            if (item->IsInitOK() == false) {
+                global::printErrorAndExit(item->getErrorMessage() + ": ", itemLine);
+            }
+        }
+        loadingItems.clear();
+    };
+    auto printLineErrorAndExit = [&finishLoadingItems](string message, string_view line) {
+        finishLoadingItems();
+        global::printErrorAndExit(message, string(line));
+    };
+
+    // create aliases, groups and items from parsed config line,
+    // aliases are expanded before they are used by items
+    SettingItem * lastItem = nullptr;
+    bool isAliasChanged = false;
+    auto applyRecord = [&](const ConfigRecord &record) {
+        const auto &fields = record.fields;
+        switch (record.type) {
+        case ConfigRecordType::alias: {
+            string name = '$' + string(fields[0]) + '$';
+            string value = string(fields[1]);
+            cout << name << ' ' << value << endl;
+            global::aliases[name] = std::move(value);
+            isAliasChanged = true;
+            break;
+        }
+        case ConfigRecordType::group:
+            settingGroups.push_back(new SettingGroup(string(fields[0]), string(fields[1])));
+            break;
+        case ConfigRecordType::minorText:
+            if (lastItem == nullptr)
+                printLineErrorAndExit("cannot process line: ", record.line);
+            lastItem->setMinorText(string(fields[0]));
+            break;
+        case ConfigRecordType::infoText:
+        case ConfigRecordType::item: {
+            if (isAliasChanged) global::expandAliases();
+            isAliasChanged = false;
+
+            // create setting item
+            SettingItem *item;
+            if (record.type == ConfigRecordType::infoText) {
+                item = new SettingItem(string(fields[0]));
+            } else {
+                item = new SettingItem(
+                    string(fields[0]), 
+                    string(fields[1]), 
+                    string(fields[2]),
+                    string(fields[3]), 
+                    string(fields[4]),
+                    string(fields[5]),
+                    string(fields[6]),
+                    string(fields[7])
+                );
+                item->setValueSpan(record.lineOffset + record.valueStart,
+                    string(record.line.substr(record.valueStart, record.valueLength)));
+            }
+
+            // add item to recent created group
+            settingGroups.back()->addItem(item);
+            loadingItems.emplace_back(item, string(record.line));
+
+            // report invalid item without waiting for the rest of file
+            if (!item->getErrorMessage().empty()) finishLoadingItems();
+
+            // store last item
+            lastItem = item;
+            break;
+        }
+        }
+    };
+
+    // replay compiled config if it is still up to date
+    string cacheFilename = getConfigCacheFilename(filename);
+    bool isCacheLoaded = false;
+    if (isUseCache) {
+        ConfigCacheReader cache(cacheFilename, filename);
+        if (cache.isValid()) {
+            ConfigRecord record;
+            while (cache.nextRecord(record)) applyRecord(record);
+            isCacheLoaded = true;
+        }
+    }
+
+    if (!isCacheLoaded) {
+        // open file
+        ConfigFile file(filename);
+
+        if (!file.isOpen()) global::printErrorAndExit("cannot open file: ", filename);
+
+        // iterate all input line, empty lines and comments are skipped
+        ConfigCacheWriter cacheWriter(filename, file.getData());
+        string_view line;
+        while (file.nextLine(line))
+        {
+            ConfigLineReader reader(line);
+            ConfigRecord record;
+            string errorMessage;
+            if (!parseConfigLine(line, reader, record, errorMessage))
+                printLineErrorAndExit(errorMessage, line);
+
+            record.lineOffset = file.getOffset(line);
+            if (isUseCache) cacheWriter.add(record);
+            applyRecord(record);
+        }
+
+        // store compiled config for next run
+        if (isUseCache) cacheWriter.save(cacheFilename);
+    }
+
+    // wait for all background commands, they compile commands with all aliases
+    if (isAliasChanged) global::expandAliases();
+    {
+        TraceScope waitScope("wait for commands", "config");
+        finishLoadingItems();
+    }
+
+    // remove default empty group
+    if (settingGroups.front()->getSize() == 0)
+    {
+        settingGroups.erase(settingGroups.begin());
+    }
+
+    // set enivornment variable
+    setenv("IS_LOADING", "false", 1);
+
+    return settingGroups;
+}
+
+void saveSettingsFile(const string & filename, const vector<SettingGroup*> & settingGroups,
+    bool isUseCache) {
+    TraceScope traceScope("saveConfigFile", "save", filename);
+
+    // keep file untouched if nothing changed since loading
+    if (!isAnySettingChanged(settingGroups)) return;
+
+    // patch values in place, so comments and layout are kept,
+    // write whole file if it was changed by someone else
+    string text;
+    if (!patchConfigText(filename, settingGroups, text)) text = generateConfigText(settingGroups);
+
+    // replace file, exit if file cannot be written
+    if (File_utils::hasContent(filename, text)) return;
+    if (!File_utils::writeFileAtomic(filename, text))
+        global::printErrorAndExit("cannot open file: ", filename);
+
+    // compile saved text, so cache matches new modification time
+    if (isUseCache) compileConfigCache(filename, getConfigCacheFilename(filename));
+}
+
+void saveOptionFiles(const vector<SettingGroup*> & settingGroups)
+{
+    TraceScope traceScope("saveOptionsFile", "save");
+
+    // write all settings to file
+    for (auto &group : settingGroups)
+    {
+        // get filename, skip this group if empty
+        auto filename = group->getOutputFilename();
+        if (filename.empty()) continue;
+
+        ostringstream file;
+        for (auto &item : group->getItems())
+        {
+            // info text has no option
+            if (item->isInfoText()) continue;
+
+            auto id = item->getID();
+            auto opt = item->getOptions()[item->getSelectedIndex()];
+
+            // keep saved option of unknown value, skip item if there is none
+            if (item->isValueUnknown() && !findSavedOption(filename, id, opt)) continue;
+            if (id.empty() && opt.empty()) continue;
+            // separate from previous option, skipped items leave no space
+            if (file.tellp() > 0) file << ' ';
+            file << id << ' ' << opt;
+        }
+
+        // skip this group if file is unchanged or cannot be written
+        if (File_utils::hasContent(filename, file.str())) continue;
+        if (!File_utils::writeFileAtomic(filename, file.str()))
+            cerr << "cannot open file: " << filename << endl;
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef SETTINGS_FILE_H
+#define SETTINGS_FILE_H
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#include "setting_group.h"
+
+// load aliases, groups and items of config file, exit on invalid line,
+// replay compiled cache of config file if isUseCache is set
+vector<SettingGroup*> loadSettingsFile(const string & filename, bool isUseCache);
+
+// write changed values of settings back into config file
+void saveSettingsFile(const string & filename, const vector<SettingGroup*> & settingGroups,
+    bool isUseCache);
+
+// write option files of groups with output filename
+void saveOptionFiles(const vector<SettingGroup*> & settingGroups);
+
+#endif // SETTINGS_FILE_H
@@ -0,0 +1,151 @@
+#include "shell_batch.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "process_runner.h"
+#include "tracer.h"
+
+extern char **environ;
+
+namespace {
+    // quote string for sh, so it can be passed to eval as one word
+    string shellQuote(const string & s) {
+        string quoted = "'";
+        for (char ch : s) {
+            if (ch == '\'') quoted += "'\\''";
+            else quoted += ch;
+        }
+        quoted += '\'';
+        return quoted;
+    }
+
+    // write all of text, a write to a shell that exited fails with EPIPE,
+    // SIGPIPE is blocked meanwhile and dropped if the write raised it
+    bool writeAll(int fd, const string & text) {
+        sigset_t pipeSignal, oldMask, pending;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        sigpending(&pending);
+        bool isAlreadyPending = sigismember(&pending, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, &oldMask);
+
+        size_t written = 0;
+        bool isWritten = true;
+        while (written < text.length()) {
+            ssize_t length = write(fd, text.data() + written, text.length() - written);
+            if (length < 0) {
+                if (errno == EINTR) continue;
+                isWritten = false;
+                break;
+            }
+            written += static_cast<size_t>(length);
+        }
+
+        if (!isWritten && errno == EPIPE && !isAlreadyPending) {
+            timespec noWait = { 0, 0 };
+            while (sigtimedwait(&pipeSignal, nullptr, &noWait) < 0 && errno == EINTR) {}
+        }
+        pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+        return isWritten;
+    }
+}
+
+ShellBatch::ShellBatch()
+{
+    // close-on-exec, the shell gets its own copies through dup2
+    int inputPipe[2], statusPipe[2];
+    if (pipe2(inputPipe, O_CLOEXEC) != 0) return;
+    if (pipe2(statusPipe, O_CLOEXEC) != 0) {
+        ::close(inputPipe[0]);
+        ::close(inputPipe[1]);
+        return;
+    }
+
+    // commands are read from stdin, statuses are written to fd 3
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, inputPipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, statusPipe[1], 3);
+
+    // commands get default SIGPIPE even if it is ignored by whoever started us
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+
+    char shell[] = "/bin/sh";
+    char *argv[] = { shell, nullptr };
+    pid_t pid;
+    int error = posix_spawn(&pid, shell, &actions, &attributes, argv, environ);
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+
+    ::close(inputPipe[0]);
+    ::close(statusPipe[1]);
+    if (error != 0) {
+        ::close(inputPipe[1]);
+        ::close(statusPipe[0]);
+        return;
+    }
+
+    pid_ = pid;
+    input_ = inputPipe[1];
+    status_ = fdopen(statusPipe[0], "r");
+}
+
+ShellBatch::~ShellBatch()
+{
+    close();
+}
+
+void ShellBatch::close()
+{
+    if (input_ >= 0) ::close(input_);
+    if (status_ != nullptr) fclose(status_);
+    input_ = -1;
+    status_ = nullptr;
+
+    // shell exits on end of input
+    if (pid_ > 0) waitpid(pid_, nullptr, 0);
+    pid_ = -1;
+}
+
+int ShellBatch::run(const string & command)
+{
+    // run command in a shell of its own if the shared shell is gone
+    if (!isRunning()) {
+        return runProcess(command).exitStatus;
+    }
+
+    TraceScope traceScope("shell", "command", command);
+
+    // each command runs in a subshell, so cd, export, set or exit in one
+    // command do not affect the next ones, eval keeps syntax errors in the
+    // subshell, command must not read the script from stdin or write to
+    // the status pipe
+    string line = "(eval " + shellQuote(command) + ") </dev/null 3>&-; echo $? >&3\n";
+    if (!writeAll(input_, line)) {
+        close();
+        return -1;
+    }
+
+    // shell is gone if no status comes back
+    char buffer[32];
+    if (fgets(buffer, sizeof buffer, status_) == nullptr) {
+        close();
+        return -1;
+    }
+    return atoi(buffer);
+}
@@ -0,0 +1,37 @@
+#ifndef SHELL_BATCH_H
+#define SHELL_BATCH_H
+
+#include <cstdio>
+#include <string>
+
+#include <sys/types.h>
+
+using std::string;
+
+// one long-lived /bin/sh, commands are written to its stdin one by one,
+// each runs in a subshell and its exit status is read back from a separate pipe
+class ShellBatch
+{
+public:
+    ShellBatch();
+    ~ShellBatch();
+
+    // disallow copying and assignment
+    ShellBatch(const ShellBatch &) = delete;
+    ShellBatch &operator=(const ShellBatch &) = delete;
+
+    bool isRunning() const { return pid_ > 0; }
+
+    // run command and wait for it, return exit status of the command,
+    // or -1 if the shell exited while running it
+    int run(const string & command);
+
+private:
+    void close();
+
+    pid_t pid_ = -1;
+    int input_ = -1;
+    FILE *status_ = nullptr;
+};
+
+#endif // SHELL_BATCH_H
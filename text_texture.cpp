@@ -1,40 +1,102 @@
 #include "text_texture.h"
 
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <tuple>
 #include <SDL.h>
 #include <SDL_image.h>
 
+#include "profiler.h"
+#include "tracer.h"
+
+using std::cerr, std::endl;
+
+namespace {
+    // texts are rasterized at double font size and scaled down
+    const double SCALE = 0.5;
+
+    // textures shared by all TextTexture of the same text, font, color and
+    // wrap length, an entry expires when its last TextTexture is deleted
+    struct CachedTexture {
+        std::weak_ptr<SDL_Texture> texture;
+        int width, height;
+    };
+    using TextureKey = std::tuple<TTF_Font*, string, Uint32, unsigned int>;
+    std::map<TextureKey, CachedTexture> textureCache;
+
+    // expired entries of texts not shown again, e.g. changing minor texts,
+    // are removed when cache has grown to twice its size after last pruning
+    const size_t MIN_PRUNE_SIZE = 64;
+    size_t pruneSize = MIN_PRUNE_SIZE;
+
+    void pruneTextureCache() {
+        if (textureCache.size() < pruneSize) return;
+        for (auto it = textureCache.begin(); it != textureCache.end(); ) {
+            if (it->second.texture.expired()) it = textureCache.erase(it);
+            else ++it;
+        }
+        pruneSize = std::max(MIN_PRUNE_SIZE, textureCache.size() * 2);
+    }
+
+    Uint32 packColor(SDL_Color color) {
+        return static_cast<Uint32>(color.r) << 24 | static_cast<Uint32>(color.g) << 16 |
+            static_cast<Uint32>(color.b) << 8 | color.a;
+    }
+}
+
 TextTexture::TextTexture(const string & text, TTF_Font *font, SDL_Color color, 
     TextureAlignment alignment)
     : text_(text)
 {
-    // create surface
-    SDL_Surface *surface = TTF_RenderUTF8_Blended(
-        font,
-        text.c_str(),
-        color
-    );
-    
-    init(surface, alignment, 0.5);
-
-    // free surface
-	SDL_FreeSurface(surface);
+    create(font, color, alignment, 0);
 } 
 
 TextTexture::TextTexture(const string & text, TTF_Font *font, SDL_Color color, 
     TextureAlignment alignment, unsigned int wrapLength)
     : text_(text)
 {
+    create(font, color, alignment, wrapLength);
+} 
+
+void TextTexture::create(TTF_Font *font, SDL_Color color, 
+    TextureAlignment alignment, unsigned int wrapLength)
+{
+    ProfileScope profileScope(ProfilePhase::textures);
+
+    // share texture of identical text if it is still alive
+    TextureKey key { font, text_, packColor(color), wrapLength };
+    auto it = textureCache.find(key);
+    if (it != textureCache.end()) {
+        auto texture = it->second.texture.lock();
+        if (texture != nullptr) {
+            init(texture,
+                static_cast<int>(it->second.width * SCALE),
+                static_cast<int>(it->second.height * SCALE),
+                alignment);
+            return;
+        }
+        textureCache.erase(it);
+    }
+
     // create surface
-    SDL_Surface *surface = TTF_RenderUTF8_Blended_Wrapped(
-        font,
-        text.c_str(),
-        color,
-        wrapLength
-    );
+    TraceScope traceScope("rasterize text", "texture", text_);
+    SDL_Surface *surface = (wrapLength == 0) ?
+        TTF_RenderUTF8_Blended(font, text_.c_str(), color) :
+        TTF_RenderUTF8_Blended_Wrapped(font, text_.c_str(), color, wrapLength);
+    if (surface == nullptr) {
+        cerr << "cannot render text: " << text_ << endl;
+        init(0, 0, alignment);
+        return;
+    }
 
-    init(surface, alignment, 0.5);
+    init(surface, alignment, SCALE);
+    if (getSharedTexture() != nullptr) {
+        pruneTextureCache();
+        textureCache[key] = { getSharedTexture(), surface->w, surface->h };
+    }
 
     // free surface
 	SDL_FreeSurface(surface);
-} 
-
+}
@@ -25,6 +25,8 @@ public:
     const string & getText() const { return text_; }
 
 private:
+    void create(TTF_Font *font, SDL_Color color, 
+        TextureAlignment alignment, unsigned int wrapLength);
 
     const string text_;
 };
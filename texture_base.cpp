@@ -31,16 +31,41 @@ void TextureBase::init(SDL_Surface *surface, TextureAlignment alignment, double
     isInitialized_ = true;
 }
 
+void TextureBase::init(int width, int height, TextureAlignment alignment) 
+{
+    alignment_ = alignment;
+
+    // init width and height
+    w_ = width;
+    h_ = height;
+
+    // compute render rect
+    updateTargetRect(alignment);
+
+    // set flag
+    isInitialized_ = true;
+}
+
+void TextureBase::init(const std::shared_ptr<SDL_Texture> &texture, int width, int height,
+    TextureAlignment alignment)
+{
+    texture_ = texture;
+    init(width, height, alignment);
+}
+
 void TextureBase::createTexture(SDL_Surface *surface) {
-   texture_ = SDLTextureUniquePtr {
-        SDL_CreateTextureFromSurface(
-            global::renderer,
-            surface)
-    };
-    if (texture_ == nullptr)
+    texture_.reset();
+
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(
+        global::renderer,
+        surface);
+    if (texture == nullptr) {
         cerr << ("Texture creation failed") << endl;
+        return;
+    }
 
-    SDL_SetTextureBlendMode(texture_.get(), SDL_BLENDMODE_BLEND);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    texture_ = std::shared_ptr<SDL_Texture>(texture, SDLTextureDeleter());
 }
 
 
@@ -50,73 +75,67 @@ void TextureBase::updateTargetRect(TextureAlignment alignment) {
     rect_.h = h_;
     switch (alignment) {
         case TextureAlignment::topCenter:
-            rect_.x = -(w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2;
+            rect_.x = (global::LOGICAL_WIDTH - w_) / 2;
+            rect_.y = 0;
         break;
         case TextureAlignment::topLeft:
-            rect_.x = -(w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 + 
-                (global::SCREEN_HEIGHT - w_) / 2;
+            rect_.x = 0;
+            rect_.y = 0;
         break;
         case TextureAlignment::topRight:
-            rect_.x = -(w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 - 
-                (global::SCREEN_HEIGHT - w_) / 2;
+            rect_.x = global::LOGICAL_WIDTH - w_;
+            rect_.y = 0;
         break;
         case TextureAlignment::bottomCenter:
-            rect_.x = (global::SCREEN_WIDTH - w_) + (w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2;
+            rect_.x = (global::LOGICAL_WIDTH - w_) / 2;
+            rect_.y = global::LOGICAL_HEIGHT - h_;
         break;
         case TextureAlignment::bottomLeft:
-            rect_.x = (global::SCREEN_WIDTH - w_) + (w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 +
-            	(global::SCREEN_HEIGHT - w_) / 2;
+            rect_.x = 0;
+            rect_.y = global::LOGICAL_HEIGHT - h_;
         break;
         case TextureAlignment::bottomRight:
-            rect_.x = (global::SCREEN_WIDTH - w_) + (w_ - h_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2 -
-                (global::SCREEN_HEIGHT - w_) / 2;
+            rect_.x = global::LOGICAL_WIDTH - w_;
+            rect_.y = global::LOGICAL_HEIGHT - h_;
         break;
         case TextureAlignment::center:
-            rect_.x = (global::SCREEN_WIDTH - w_) / 2;
-            rect_.y = (global::SCREEN_HEIGHT - h_) / 2;
+            rect_.x = (global::LOGICAL_WIDTH - w_) / 2;
+            rect_.y = (global::LOGICAL_HEIGHT - h_) / 2;
         break;
     }
 }
 
 void TextureBase::FitScreenSize(int marginX, int marginY) {
 
-    if (w_ > global::SCREEN_HEIGHT - marginX * 2) 
-        w_ = global::SCREEN_HEIGHT - marginX * 2;
-    if (h_ > global::SCREEN_WIDTH - marginY * 2) 
-        h_ = global::SCREEN_WIDTH - marginY * 2;
+    if (w_ > global::LOGICAL_WIDTH - marginX * 2) 
+        w_ = global::LOGICAL_WIDTH - marginX * 2;
+    if (h_ > global::LOGICAL_HEIGHT - marginY * 2) 
+        h_ = global::LOGICAL_HEIGHT - marginY * 2;
 
     updateTargetRect(alignment_);
 }
 
 void TextureBase::render() const {
-    SDL_RenderCopyEx(global::renderer, 
-        texture_.get(), 
-        nullptr, 
-        &rect_,
-        270, nullptr, SDL_FLIP_NONE
-    );
+    renderRect(rect_);
 }
 
 void TextureBase::render(int offsetX, int offsetY) const {
     auto rect = rect_;
-    rect.x += offsetY;
-    rect.y -= offsetX;
+    rect.x += offsetX;
+    rect.y += offsetY;
+
+    renderRect(rect);
+}
 
-    SDL_RenderCopyEx(global::renderer, 
+void TextureBase::renderRect(const SDL_Rect &rect) const {
+    SDL_RenderCopy(global::renderer, 
         texture_.get(), 
         nullptr, 
-        &rect,
-        270, nullptr, SDL_FLIP_NONE
+        &rect
     );
 }
 
 void TextureBase::scrollLeft(int offset) {
-    rect_.y += offset;
+    rect_.x -= offset;
 }
 
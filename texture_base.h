@@ -1,6 +1,8 @@
 #ifndef TEXTURE_BASE_H
 #define TEXTURE_BASE_H
 
+#include <memory>
+
 #include "sdl_unique_ptr.h"
 
 enum class TextureAlignment { topCenter, topLeft, topRight, bottomCenter, bottomLeft, bottomRight, center };
@@ -17,6 +19,9 @@ public:
     TextureBase &operator=(const TextureBase &) = delete;
 
     void init(SDL_Surface *surface, TextureAlignment alignment, double scale=1.0);
+    void init(int width, int height, TextureAlignment alignment);
+    void init(const std::shared_ptr<SDL_Texture> &texture, int width, int height,
+        TextureAlignment alignment);
     void updateTargetRect(TextureAlignment alignment);
     void FitScreenSize(int marginX=0, int marginY=0);
     void render() const;
@@ -27,6 +32,11 @@ public:
     int getWidth() const { return w_; }
     int getHeight() const { return h_; }
     SDL_Texture * getTexture() const { return texture_.get(); }
+    const std::shared_ptr<SDL_Texture> & getSharedTexture() const { return texture_; }
+
+protected:
+    // draw content to target rect in landscape screen
+    virtual void renderRect(const SDL_Rect &rect) const;
 
 private:
     void createTexture(SDL_Surface *surface);
@@ -34,7 +44,7 @@ private:
     bool isInitialized_ = false; 
     int w_, h_;
     SDL_Rect rect_;
-    SDLTextureUniquePtr texture_ = nullptr;
+    std::shared_ptr<SDL_Texture> texture_;
     TextureAlignment alignment_;
 };
 
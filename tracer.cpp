@@ -0,0 +1,110 @@
+#include "tracer.h"
+
+#include "global.h"
+
+namespace {
+    // write string as JSON string literal
+    void writeJsonString(FILE *file, const string & s) {
+        fputc('"', file);
+        for (char ch : s) {
+            auto c = static_cast<unsigned char>(ch);
+            if (ch == '"' || ch == '\\') fprintf(file, "\\%c", ch);
+            else if (ch == '\n') fputs("\\n", file);
+            else if (ch == '\t') fputs("\\t", file);
+            else if (c < 0x20) fprintf(file, "\\u%04x", c);
+            else fputc(ch, file);
+        }
+        fputc('"', file);
+    }
+}
+
+Tracer::Tracer()
+    : isEnabled_(false), startTime_(std::chrono::steady_clock::now())
+{
+}
+
+Tracer::~Tracer()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    isEnabled_.store(false, std::memory_order_relaxed);
+    if (file_ == nullptr) return;
+
+    fputs("\n]\n", file_);
+    fclose(file_);
+    file_ = nullptr;
+}
+
+bool Tracer::open(const string & filename)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ != nullptr) fclose(file_);
+
+    file_ = fopen(filename.c_str(), "w");
+    isEnabled_.store(file_ != nullptr, std::memory_order_relaxed);
+    if (file_ == nullptr) return false;
+
+    fputs("[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"easyConfig\"}}", file_);
+
+    // tracer is opened by main thread, workers may write events before it
+    threadIds_.clear();
+    addThread(std::this_thread::get_id(), "main");
+    return true;
+}
+
+long long Tracer::now() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime_).count();
+}
+
+int Tracer::getThreadId()
+{
+    auto id = std::this_thread::get_id();
+    auto it = threadIds_.find(id);
+    if (it != threadIds_.end()) return it->second;
+
+    // main thread is added on open, other threads are workers
+    return addThread(id, "worker " + std::to_string(threadIds_.size()));
+}
+
+int Tracer::addThread(std::thread::id id, const string & name)
+{
+    int threadId = static_cast<int>(threadIds_.size()) + 1;
+    threadIds_[id] = threadId;
+
+    fprintf(file_, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", threadId);
+    writeJsonString(file_, name);
+    fputs("}}", file_);
+    return threadId;
+}
+
+void Tracer::addSpan(const char *name, const char *category, long long start, long long duration,
+    const string & detail)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ == nullptr) return;
+
+    int threadId = getThreadId();
+    fprintf(file_, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d",
+        name, category, start, duration, threadId);
+    if (!detail.empty()) {
+        fputs(",\"args\":{\"detail\":", file_);
+        writeJsonString(file_, detail);
+        fputc('}', file_);
+    }
+    fputc('}', file_);
+}
+
+TraceScope::TraceScope(const char *name, const char *category, const string & detail)
+    : name_(name), category_(category)
+{
+    if (!global::tracer.isEnabled()) return;
+    detail_ = detail;
+    start_ = global::tracer.now();
+}
+
+TraceScope::~TraceScope()
+{
+    if (start_ < 0) return;
+    global::tracer.addSpan(name_, category_, start_, global::tracer.now() - start_, detail_);
+}
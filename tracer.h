@@ -0,0 +1,69 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using std::string;
+
+// writer of trace events in Chrome JSON format, open in chrome://tracing
+// or Perfetto to see startup and commands on a timeline
+class Tracer
+{
+public:
+    Tracer();
+    ~Tracer();
+
+    // disallow copying and assignment
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    // start writing events to file, return false if file cannot open
+    bool open(const string & filename);
+
+    bool isEnabled() const { return isEnabled_.load(std::memory_order_relaxed); }
+
+    // microseconds since tracer was created
+    long long now() const;
+
+    // write complete event of current thread, detail is shown as argument
+    void addSpan(const char *name, const char *category, long long start, long long duration,
+        const string & detail = "");
+
+private:
+    // small id of current thread, name is written on first use
+    int getThreadId();
+    // give next id to thread and write its name
+    int addThread(std::thread::id id, const string & name);
+
+    std::atomic<bool> isEnabled_;
+    const std::chrono::steady_clock::time_point startTime_;
+    std::mutex mutex_;
+    FILE *file_ = nullptr;
+    std::map<std::thread::id, int> threadIds_;
+};
+
+// span from creation to end of scope if tracer is enabled
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name, const char *category, const string & detail = "");
+    ~TraceScope();
+
+    // disallow copying and assignment
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name_;
+    const char *category_;
+    string detail_;
+    long long start_ = -1;
+};
+
+#endif // TRACER_H
@@ -0,0 +1,52 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(unsigned int maxWorkers)
+    : maxWorkers_(maxWorkers > 0 ? maxWorkers : 1)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopping_ = true;
+        tasks_.clear();
+    }
+    condition_.notify_all();
+
+    for (auto &worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void WorkerPool::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+
+        // start a new worker if all existing workers are busy
+        if (idleWorkers_ < tasks_.size() && workers_.size() < maxWorkers_) {
+            workers_.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+    condition_.notify_one();
+}
+
+void WorkerPool::workerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idleWorkers_++;
+            condition_.wait(lock, [this]() { return isStopping_ || !tasks_.empty(); });
+            idleWorkers_--;
+            if (isStopping_) return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
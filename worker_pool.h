@@ -0,0 +1,50 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+public:
+    explicit WorkerPool(unsigned int maxWorkers);
+    ~WorkerPool();
+
+    // disallow copying and assignment
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    // queue a task, worker threads are created on demand up to maxWorkers
+    void post(std::function<void()> task);
+
+    // queue a task and get its result through a future
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())> {
+        using R = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::move(task));
+        auto result = packaged->get_future();
+        post([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    unsigned int getMaxWorkers() const { return maxWorkers_; }
+
+private:
+    void workerLoop();
+
+    const unsigned int maxWorkers_;
+    unsigned int idleWorkers_ = 0;
+    bool isStopping_ = false;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+};
+
+#endif // WORKER_POOL_H